@@ -10,6 +10,7 @@
 #include "ai_shiraitodai_takami.h"
 #include "ai_usuzan_sawaya.h"
 
+#include "../util/assume.h"
 #include "../util/debug_cheat.h"
 #include "../util/misc.h"
 
@@ -44,6 +45,18 @@ util::Stactor<Action, 44> allMaxs(const util::Range<Action> &range,
     return res;
 }
 
+///
+/// \brief Find the evaluation of discarding 'out' among Hand::evaluateDiscards()
+///
+const Hand::DiscardEval &findDiscard(const util::Stactor<Hand::DiscardEval, 14> &evals, T34 out)
+{
+    for (const Hand::DiscardEval &eval : evals)
+        if (eval.out == out)
+            return eval;
+
+    unreached("Ai::findDiscard");
+}
+
 bool Ai::Limits::noBark() const
 {
     return mNoBark;
@@ -303,10 +316,15 @@ Action Ai::thinkAttackStep(const TableView &view, const util::Range<Action> &out
     assert(!outs.empty());
     assert(util::all(outs, [](const Action &a) { return a.isDiscard() || a.isCp(); }));
 
+    const Hand &hand = view.myHand();
+    util::Stactor<Hand::DiscardEval, 14> evals;
+    if (hand.hasDrawn())
+        evals = hand.evaluateDiscards(view.visibleRemain());
+
     // *INDENT-OFF*
     auto stepHappy = [&](const Action &action) {
-        int step = action.isDiscard() ? view.myHand().peekDiscard(action, &Hand::step)
-                                      : view.myHand().peekCp(view.getFocusTile(), action, &Hand::step);
+        int step = action.isDiscard() ? findDiscard(evals, hand.outFor(action)).step
+                                      : hand.peekCp(view.getFocusTile(), action, &Hand::step);
         return 2 + (13 - step);
     };
     // *INDENT-ON*
@@ -323,12 +341,18 @@ Action Ai::thinkAttackEff(const TableView &view, const util::Range<Action> &outs
     assert(!outs.empty());
     assert(util::all(outs, [](const Action &a) { return a.isDiscard() || a.isCp(); }));
 
+    const Hand &hand = view.myHand();
+    const TileCount &remain = view.visibleRemain();
+    util::Stactor<Hand::DiscardEval, 14> evals;
+    if (hand.hasDrawn())
+        evals = hand.evaluateDiscards(remain);
+
     // *INDENT-OFF*
     auto happy = [&](const Action &action) {
-        const T37 &out = view.myHand().outFor(action);
-        auto effA = action.isDiscard() ? view.myHand().peekDiscard(action, &Hand::effA)
-                                       : view.myHand().peekCp(view.getFocusTile(), action, &Hand::effA);
-        int remainEffA = view.visibleRemain().ct(effA);
+        const T37 &out = hand.outFor(action);
+        int remainEffA = action.isDiscard()
+            ? findDiscard(evals, out).remainEffA
+            : remain.ct(hand.peekCp(view.getFocusTile(), action, &Hand::effA));
         int floatTrash = (5 - (view.getDrids() % out + out.isAka5()))
                 + 2 * (view.getRiver(view.self()).size() < 6 ? out.isYao() : !out.isYao());
 
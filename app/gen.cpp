@@ -1,4 +1,5 @@
 #include "gen.h"
+#include "../form/lazy_form.h"
 #include "../util/rand.h"
 #include "../util/misc.h"
 
@@ -9,10 +10,11 @@ namespace saki
 
 
 
-Gen::Gen(const Form &form, const Hand &hand, const T37 &pick)
+Gen::Gen(const Form &form, const Hand &hand, const T37 &pick, const FormCtx &ctx)
     : form(form)
     , hand(hand)
     , pick(pick)
+    , ctx(ctx)
 {
 }
 
@@ -77,14 +79,14 @@ Gen Gen::genForm4(util::Rand &rand, int triCent, int quadCent, int openCent,
             T37 pick = h.drawn();
             genInfo(rand, ctx, pick, h, ron, false);
             h.spinOut();
-            Form f(h, pick, ctx, rule);
+            LazyForm f(h, pick, ctx, rule);
             if (f.hasYaku())
-                return Gen(f, h, pick);
+                return Gen(f.form(), h, pick, ctx);
         } else {
             genInfo(rand, ctx, h.drawn(), h, ron, false);
-            Form f(h, ctx, rule);
+            LazyForm f(h, ctx, rule);
             if (f.hasYaku())
-                return Gen(f, h, h.drawn());
+                return Gen(f.form(), h, h.drawn(), ctx);
         }
     }
 }
@@ -173,14 +175,14 @@ Gen Gen::genForm4F110Horse(util::Rand &rand, int selfWind, const Rule &rule, boo
                 T37 pick = h.drawn();
                 genInfo(rand, ctx, pick, h, ron, false);
                 h.spinOut();
-                Form f(h, pick, ctx, rule);
+                LazyForm f(h, pick, ctx, rule);
                 if (f.hasYaku())
-                    return Gen(f, h, pick);
+                    return Gen(f.form(), h, pick, ctx);
             } else {
                 genInfo(rand, ctx, h.drawn(), h, ron, false);
-                Form f(h, ctx, rule);
+                LazyForm f(h, ctx, rule);
                 if (f.hasYaku())
-                    return Gen(f, h, h.drawn());
+                    return Gen(f.form(), h, h.drawn(), ctx);
             }
         }
     }
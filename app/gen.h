@@ -25,7 +25,9 @@ public:
     static Gen genForm4F110Horse(util::Rand &rand, int selfWind, const Rule &rule, bool ron);
 
 private:
-    Gen(const Form &form, const Hand &hand, const T37 &pick);
+    friend class GenBank;
+
+    Gen(const Form &form, const Hand &hand, const T37 &pick, const FormCtx &ctx);
 
     static Hand genFormal4(util::Rand &rand, int triCent, int quadCent, int openCent);
     static Hand genWild4(util::Rand &rand, int triCent, int quadCent, int openCent);
@@ -36,6 +38,7 @@ public:
     Form form;
     Hand hand;
     T37 pick;
+    FormCtx ctx;
 };
 
 
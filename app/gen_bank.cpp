@@ -0,0 +1,296 @@
+#include "gen_bank.h"
+
+#include <cassert>
+
+
+
+namespace saki
+{
+
+
+
+GenBank::GenBank(int selfWind, int roundWind, const Rule &rule, bool ron)
+    : mSelfWind(selfWind)
+    , mRoundWind(roundWind)
+    , mRule(rule)
+    , mRon(ron)
+{
+    assert(1 <= selfWind && selfWind <= 4);
+    assert(1 <= roundWind && roundWind <= 4);
+}
+
+///
+/// \brief Run the monkey generators and keep the results by bucket
+/// \param tryCt Number of generated hands, rare buckets need more
+///
+/// Rotates through the profiles of Gen::genForm4FuHan() and
+/// Gen::genForm4Mangan(), plus a high-fu open profile which hits
+/// buckets like 100-1 tsumo much more often, and
+/// Gen::genForm4F110Horse() if applicable.
+///
+void GenBank::fill(util::Rand &rand, int tryCt)
+{
+    // tri, quad, and open percentage
+    static const std::array<std::array<int, 3>, 4> PROFILES {
+        std::array<int, 3> { 20, 10, 30 }, // low fu
+        std::array<int, 3> { 60, 70, 2 }, // high fu
+        std::array<int, 3> { 60, 70, 30 }, // high fu, open
+        std::array<int, 3> { 20, 10, 5 } // mangan
+    };
+
+    const bool f110 = mSelfWind == mRoundWind;
+    const int profileCt = PROFILES.size() + (f110 ? 1 : 0);
+
+    for (int i = 0; i < tryCt; i++) {
+        size_t p = i % profileCt;
+        if (p < PROFILES.size()) {
+            const auto &pr = PROFILES[p];
+            add(Gen::genForm4(rand, pr[0], pr[1], pr[2], mSelfWind, mRoundWind, mRule, mRon));
+        } else {
+            add(Gen::genForm4F110Horse(rand, mSelfWind, mRule, mRon));
+        }
+    }
+}
+
+///
+/// \brief Same as fill(rand, tryCt) but run by the threads of 'pool'
+///
+void GenBank::fill(util::ThreadPool &pool, util::Rand &rand, int tryCt)
+{
+    std::vector<util::Rand> rands;
+    rands.reserve(FILL_PART_CT);
+    for (int i = 0; i < FILL_PART_CT; i++)
+        rands.push_back(rand.split(i));
+
+    rand.gen(); // next fill splits other streams
+
+    std::vector<GenBank> parts(FILL_PART_CT, GenBank(mSelfWind, mRoundWind, mRule, mRon));
+
+    // *INDENT-OFF*
+    pool.run(FILL_PART_CT, [&](int i) {
+        parts[i].fill(rands[i], tryCt / FILL_PART_CT + (i < tryCt % FILL_PART_CT ? 1 : 0));
+    });
+    // *INDENT-ON*
+
+    for (const GenBank &part : parts)
+        merge(part);
+}
+
+bool GenBank::hasFuHan(int fu, int han) const
+{
+    return mFuHans.count(std::make_pair(fu, han)) > 0;
+}
+
+bool GenBank::hasMangan(int han) const
+{
+    return mMangans.count(han) > 0;
+}
+
+///
+/// \brief Same as Gen::genForm4FuHan() with the bank's winds, rule, and ron
+/// \pre hasFuHan(fu, han)
+///
+/// A stored sample is varied by a random symmetry. If the varied hand
+/// has a different fu or han, the stored sample itself is returned.
+///
+Gen GenBank::genForm4FuHan(util::Rand &rand, int fu, int han) const
+{
+    auto it = mFuHans.find(std::make_pair(fu, han));
+    assert(it != mFuHans.end());
+    return pick(rand, it->second);
+}
+
+///
+/// \brief Same as Gen::genForm4Mangan() with the bank's winds, rule, and ron
+/// \pre hasMangan(han)
+///
+/// A stored sample is varied by a random symmetry. If the varied hand
+/// has a different fu or han, the stored sample itself is returned.
+///
+Gen GenBank::genForm4Mangan(util::Rand &rand, int han) const
+{
+    auto it = mMangans.find(han);
+    assert(it != mMangans.end());
+    return pick(rand, it->second);
+}
+
+///
+/// \brief Append 'ct' results of genForm4FuHan() to 'res'
+///
+void GenBank::genForm4FuHans(util::Rand &rand, int fu, int han, int ct,
+                             std::vector<Gen> &res) const
+{
+    auto it = mFuHans.find(std::make_pair(fu, han));
+    assert(it != mFuHans.end());
+
+    res.reserve(res.size() + ct);
+    for (int i = 0; i < ct; i++)
+        res.push_back(pick(rand, it->second));
+}
+
+///
+/// \brief Append 'ct' results of genForm4Mangan() to 'res'
+///
+void GenBank::genForm4Mangans(util::Rand &rand, int han, int ct, std::vector<Gen> &res) const
+{
+    auto it = mMangans.find(han);
+    assert(it != mMangans.end());
+
+    res.reserve(res.size() + ct);
+    for (int i = 0; i < ct; i++)
+        res.push_back(pick(rand, it->second));
+}
+
+void GenBank::push(Samples &samples, const Gen &gen)
+{
+    if (samples.size() < static_cast<size_t>(BUCKET_CAP))
+        samples.push_back(gen);
+}
+
+void GenBank::add(const Gen &gen)
+{
+    const Form &f = gen.form;
+    if (f.isPrototypalYakuman())
+        return;
+
+    push(mFuHans[std::make_pair(f.fu(), f.han())], gen);
+    if (f.manganType() != ManganType::HR)
+        push(mMangans[f.han()], gen);
+}
+
+void GenBank::merge(const GenBank &that)
+{
+    for (const auto &pair : that.mFuHans)
+        for (const Gen &gen : pair.second)
+            push(mFuHans[pair.first], gen);
+
+    for (const auto &pair : that.mMangans)
+        for (const Gen &gen : pair.second)
+            push(mMangans[pair.first], gen);
+}
+
+Gen GenBank::pick(util::Rand &rand, const Samples &samples) const
+{
+    assert(!samples.empty());
+    return morph(rand, samples[rand.gen(static_cast<int>(samples.size()))]);
+}
+
+///
+/// \brief Apply a random symmetry to a sample
+/// \return The varied sample, or the original one if the score changed
+///
+Gen GenBank::morph(util::Rand &rand, const Gen &gen) const
+{
+    std::array<int, 34> sym = genSymmetry(rand);
+    // *INDENT-OFF*
+    auto map = [&sym](const T37 &t) {
+        return T37(sym[t.id34()]);
+    };
+    // *INDENT-ON*
+
+    TileCount closed;
+    for (T34 t : tiles34::ALL34) {
+        int ct = gen.hand.closed().ct(t);
+        if (ct > 0)
+            closed.inc(T37(sym[t.id34()]), ct);
+    }
+
+    util::Stactor<M37, 4> barks;
+    for (const M37 &m : gen.hand.barks()) {
+        const auto &ts = m.tiles();
+        switch (m.type()) {
+        case M37::Type::CHII: {
+            T37 l = map(ts[0]);
+            T37 r = map(ts[2]);
+            int lay = m.layIndex();
+            if (l.id34() > r.id34()) { // mirrored
+                std::swap(l, r);
+                lay = 2 - lay;
+            }
+
+            barks.pushBack(M37::chii(l, map(ts[1]), r, lay));
+            break;
+        }
+        case M37::Type::PON:
+            barks.pushBack(M37::pon(map(ts[0]), map(ts[1]), map(ts[2]), m.layIndex()));
+            break;
+        case M37::Type::DAIMINKAN:
+            barks.pushBack(M37::daiminkan(map(ts[0]), map(ts[1]), map(ts[2]), map(ts[3]),
+                                          m.layIndex()));
+            break;
+        case M37::Type::ANKAN:
+            barks.pushBack(M37::ankan(map(ts[0]), map(ts[1]), map(ts[2]), map(ts[3])));
+            break;
+        case M37::Type::KAKAN: {
+            M37 kakan = M37::pon(map(ts[0]), map(ts[1]), map(ts[2]), m.layIndex());
+            kakan.kakan(map(ts[3]));
+            barks.pushBack(kakan);
+            break;
+        }
+        }
+    }
+
+    Hand h(closed, barks);
+    T37 pick = map(gen.pick);
+    if (!mRon)
+        h.draw(pick);
+
+    Form f = mRon ? Form(h, pick, gen.ctx, mRule) : Form(h, gen.ctx, mRule);
+    if (f.fu() != gen.form.fu() || f.han() != gen.form.han())
+        return gen;
+
+    return Gen(f, h, pick, gen.ctx);
+}
+
+///
+/// \brief Generate a random yaku-preserving mapping of 34-ids
+///
+/// Value winds stay in place, as they are what the bank is built for
+///
+std::array<int, 34> GenBank::genSymmetry(util::Rand &rand) const
+{
+    // *INDENT-OFF*
+    auto shuffle = [&rand](int *begin, int size) {
+        for (int i = size - 1; i > 0; i--)
+            std::swap(begin[i], begin[rand.gen(i + 1)]);
+    };
+    // *INDENT-ON*
+
+    std::array<int, 3> suits { 0, 1, 2 };
+    shuffle(suits.data(), 3);
+    bool mirror = rand.gen(2) == 0;
+
+    std::array<int, 3> dragons { 0, 1, 2 };
+    shuffle(dragons.data(), 3);
+
+    std::array<int, 4> winds;
+    std::array<int, 4> frees;
+    int freeCt = 0;
+    for (int w = 0; w < 4; w++) {
+        winds[w] = w;
+        if (w + 1 != mSelfWind && w + 1 != mRoundWind)
+            frees[freeCt++] = w;
+    }
+
+    std::array<int, 4> shuffled = frees;
+    shuffle(shuffled.data(), freeCt);
+    for (int i = 0; i < freeCt; i++)
+        winds[frees[i]] = shuffled[i];
+
+    std::array<int, 34> res;
+    for (int s = 0; s < 3; s++)
+        for (int v = 0; v < 9; v++)
+            res[9 * s + v] = 9 * suits[s] + (mirror ? 8 - v : v);
+
+    for (int w = 0; w < 4; w++)
+        res[27 + w] = 27 + winds[w];
+
+    for (int d = 0; d < 3; d++)
+        res[31 + d] = 31 + dragons[d];
+
+    return res;
+}
+
+
+
+} // namespace saki
@@ -0,0 +1,79 @@
+#ifndef SAKI_GEN_BANK_H
+#define SAKI_GEN_BANK_H
+
+#include "gen.h"
+#include "../util/thread_pool.h"
+
+#include <map>
+#include <vector>
+
+
+
+namespace saki
+{
+
+
+
+///
+/// \brief Bucketed samples for serving Gen requests in bounded time
+///
+/// The rejection loops in Gen may take thousands of Form constructions
+/// to hit a rare fu/han bucket. A bank pays that cost once in fill(),
+/// storing the hit samples by (fu, han) and by mangan han.
+/// A request then picks a stored sample and varies it by a random
+/// yaku-preserving symmetry (suit permutation, number mirroring,
+/// dragon permutation, and permutation of the non-value winds),
+/// costing one Form construction.
+///
+/// A bank serves only the winds, rule, and ron-ness it is built with.
+/// It is the reusable workspace of batch requests, and can be filled
+/// by a thread pool, where each part runs on its own util::Rand
+/// split from the caller's one, so results do not depend on the
+/// number of threads.
+///
+class GenBank
+{
+public:
+    static const int BUCKET_CAP = 64;
+    static const int FILL_PART_CT = 64;
+
+    GenBank(int selfWind, int roundWind, const Rule &rule, bool ron);
+    ~GenBank() = default;
+
+    void fill(util::Rand &rand, int tryCt);
+    void fill(util::ThreadPool &pool, util::Rand &rand, int tryCt);
+
+    bool hasFuHan(int fu, int han) const;
+    bool hasMangan(int han) const;
+
+    Gen genForm4FuHan(util::Rand &rand, int fu, int han) const;
+    Gen genForm4Mangan(util::Rand &rand, int han) const;
+    void genForm4FuHans(util::Rand &rand, int fu, int han, int ct, std::vector<Gen> &res) const;
+    void genForm4Mangans(util::Rand &rand, int han, int ct, std::vector<Gen> &res) const;
+
+private:
+    using Samples = std::vector<Gen>;
+
+    static void push(Samples &samples, const Gen &gen);
+    void add(const Gen &gen);
+    void merge(const GenBank &that);
+    Gen pick(util::Rand &rand, const Samples &samples) const;
+    Gen morph(util::Rand &rand, const Gen &gen) const;
+    std::array<int, 34> genSymmetry(util::Rand &rand) const;
+
+private:
+    const int mSelfWind;
+    const int mRoundWind;
+    const Rule mRule;
+    const bool mRon;
+    std::map<std::pair<int, int>, Samples> mFuHans;
+    std::map<int, Samples> mMangans;
+};
+
+
+
+} // namespace saki
+
+
+
+#endif // SAKI_GEN_BANK_H
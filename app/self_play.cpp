@@ -0,0 +1,220 @@
+#include "self_play.h"
+#include "../ai/ai.h"
+#include "../table/table_env_stub.h"
+#include "../table/table_tester.h"
+#include "../util/rand.h"
+
+#include <cassert>
+
+
+
+namespace saki
+{
+
+
+
+namespace
+{
+
+
+
+///
+/// \brief Collect the stats of one table, mapping seats to the line-up
+///
+class SelfPlayRecorder : public TableObserverDispatched
+{
+public:
+    explicit SelfPlayRecorder(const std::array<int, 4> &girlOfSeat)
+        : mGirlOfSeat(girlOfSeat)
+    {
+    }
+
+    void onTableEvent(const Table &table, const TE::RoundEnded &event) override
+    {
+        (void) table;
+
+        mStats.roundCt++;
+        mStats.results[static_cast<int>(event.result)]++;
+
+        if (event.result == RoundResult::TSUMO) {
+            for (Who who : event.openers)
+                mStats.tsumos[girlOf(who)]++;
+        } else if (event.result == RoundResult::RON) {
+            for (Who who : event.openers)
+                mStats.rons[girlOf(who)]++;
+
+            mStats.gunneds[girlOf(event.gunner)]++;
+        }
+    }
+
+    void onTableEvent(const Table &table, const TE::TableEnded &event) override
+    {
+        mStats.tableCt++;
+        for (int r = 0; r < 4; r++)
+            mStats.ranks[girlOf(event.ranks[r])][r]++;
+
+        // points and scores are by seat
+        for (int w = 0; w < 4; w++) {
+            int g = mGirlOfSeat[w];
+            mStats.points[g] += table.getPoints()[w];
+            mStats.scores[g] += event.scores[w];
+        }
+    }
+
+    const SelfPlay::Stats &stats() const
+    {
+        return mStats;
+    }
+
+private:
+    int girlOf(Who who) const
+    {
+        return mGirlOfSeat[who.index()];
+    }
+
+private:
+    const std::array<int, 4> mGirlOfSeat;
+    SelfPlay::Stats mStats;
+};
+
+
+
+} // namespace
+
+
+
+void SelfPlay::Stats::merge(const Stats &that)
+{
+    tableCt += that.tableCt;
+    roundCt += that.roundCt;
+    for (int g = 0; g < 4; g++) {
+        for (int r = 0; r < 4; r++)
+            ranks[g][r] += that.ranks[g][r];
+
+        points[g] += that.points[g];
+        scores[g] += that.scores[g];
+        tsumos[g] += that.tsumos[g];
+        rons[g] += that.rons[g];
+        gunneds[g] += that.gunneds[g];
+    }
+
+    for (size_t i = 0; i < results.size(); i++)
+        results[i] += that.results[i];
+}
+
+///
+/// \brief Average rank of a girl in the line-up, from 1 to 4
+///
+double SelfPlay::Stats::avgRank(int girl) const
+{
+    if (tableCt == 0)
+        return 0.0;
+
+    int sum = 0;
+    for (int r = 0; r < 4; r++)
+        sum += (r + 1) * ranks[girl][r];
+
+    return static_cast<double>(sum) / tableCt;
+}
+
+///
+/// \brief Number of tsumo and ron wins per round
+///
+double SelfPlay::Stats::winRate(int girl) const
+{
+    return roundCt == 0 ? 0.0 : static_cast<double>(tsumos[girl] + rons[girl]) / roundCt;
+}
+
+///
+/// \brief Number of deal-ins per round
+///
+double SelfPlay::Stats::gunRate(int girl) const
+{
+    return roundCt == 0 ? 0.0 : static_cast<double>(gunneds[girl]) / roundCt;
+}
+
+///
+/// \brief Run config.tableCt tables on 'pool'
+/// \param report Called with the running total every BATCH_CT tables
+///               and at the end, from the calling thread
+/// \return The total stats
+///
+SelfPlay::Stats SelfPlay::run(const Config &config, util::ThreadPool &pool, const Report &report)
+{
+    Stats total;
+    std::vector<Stats> parts;
+
+    for (int begin = 0; begin < config.tableCt; begin += BATCH_CT) {
+        int left = config.tableCt - begin;
+        int ct = left < BATCH_CT ? left : BATCH_CT;
+        parts.assign(ct, Stats());
+
+        // *INDENT-OFF*
+        pool.run(ct, [&](int i) {
+            parts[i] = runTable(config, begin + i);
+        });
+        // *INDENT-ON*
+
+        for (const Stats &part : parts)
+            total.merge(part);
+
+        if (report)
+            report(total);
+    }
+
+    return total;
+}
+
+///
+/// \brief Play the table of the given index in a run to the end
+///
+/// Deterministic for a given config and index, as the AIs are.
+///
+SelfPlay::Stats SelfPlay::runTable(const Config &config, int index)
+{
+    std::array<int, 4> girlOfSeat;
+    std::array<std::unique_ptr<Girl>, 4> girls;
+    std::array<std::unique_ptr<Ai>, 4> ais;
+    std::array<TableDecider *, 4> deciders;
+    for (int w = 0; w < 4; w++) {
+        girlOfSeat[w] = config.rotate ? (w + index) % 4 : w;
+        Girl::Id id = Girl::Id(config.girlIds[girlOfSeat[w]]);
+        assert(id != Girl::Id::CUSTOM);
+
+        girls[w] = Girl::create(Who(w), id);
+        ais[w] = Ai::create(id);
+        deciders[w] = ais[w].get();
+    }
+
+    SelfPlayRecorder recorder(girlOfSeat);
+    TableEnvStub env;
+    Table::InitConfig initConfig {
+        config.points, std::move(girls), config.rule, Who(0),
+        seedOf(config.seed, index)
+    };
+
+    Table table(std::move(initConfig), { &recorder }, env);
+    TableTester tester(table, deciders);
+    tester.run();
+
+    return recorder.stats();
+}
+
+///
+/// \brief Initial state of the table of the given index in a run
+///
+/// The table's stream is split by its index from one SplitMix Rand of
+/// the run's seed, so it does not depend on which thread runs it.
+/// Tables keep the MINSTD mode, which replays record, so the stream
+/// only picks a valid state for it.
+///
+uint32_t SelfPlay::seedOf(uint64_t seed, int index)
+{
+    util::Rand stream = util::Rand::splitMix(seed).split(static_cast<uint64_t>(index));
+    // std::minstd_rand states are in [1, 2147483646]
+    return static_cast<uint32_t>(stream.gen() % 2147483646) + 1;
+}
+
+
+
+} // namespace saki
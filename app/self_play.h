@@ -0,0 +1,76 @@
+#ifndef SAKI_APP_SELF_PLAY_H
+#define SAKI_APP_SELF_PLAY_H
+
+#include "../table/table.h"
+#include "../util/thread_pool.h"
+
+#include <functional>
+
+
+
+namespace saki
+{
+
+
+
+///
+/// \brief Headless AI-only tables for tuning and regression
+///
+/// Each table of a run is built from scratch on its own thread, with its
+/// own girls, AIs, and util::Rand split by the table's index from the
+/// run's seed, so no mutable state is shared between tables except the
+/// process-wide ParseCache, which is sharded. Tables are run in batches and their
+/// stats merged in seed order, so both the reports and the final stats
+/// do not depend on the number of threads.
+///
+class SelfPlay
+{
+public:
+    struct Config
+    {
+        std::array<int, 4> girlIds;
+        Rule rule;
+        std::array<int, 4> points { 25000, 25000, 25000, 25000 };
+        uint64_t seed = 1;
+        int tableCt = 1;
+        bool rotate = true; ///< Shift the line-up by one seat per table
+    };
+
+    ///
+    /// \brief Aggregated results, indexed by the position in the line-up
+    ///
+    struct Stats
+    {
+        int tableCt = 0;
+        int roundCt = 0;
+        std::array<std::array<int, 4>, 4> ranks {}; ///< [girl][rank]
+        std::array<int64_t, 4> points {}; ///< Sum of final points
+        std::array<int64_t, 4> scores {}; ///< Sum of scores after uma
+        std::array<int, 4> tsumos {};
+        std::array<int, 4> rons {};
+        std::array<int, 4> gunneds {};
+        std::array<int, static_cast<int>(RoundResult::NUM_ROUNDRES)> results {};
+
+        void merge(const Stats &that);
+        double avgRank(int girl) const;
+        double winRate(int girl) const;
+        double gunRate(int girl) const;
+    };
+
+    static const int BATCH_CT = 64; ///< Number of tables between two reports
+
+    using Report = std::function<void(const Stats &)>;
+
+    static Stats run(const Config &config, util::ThreadPool &pool, const Report &report);
+    static Stats runTable(const Config &config, int index);
+
+    static uint32_t seedOf(uint64_t seed, int index);
+};
+
+
+
+} // namespace saki
+
+
+
+#endif // SAKI_APP_SELF_PLAY_H
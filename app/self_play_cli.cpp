@@ -0,0 +1,163 @@
+#include "self_play_cli.h"
+#include "self_play.h"
+#include "../util/string_enum.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <string>
+
+
+
+namespace saki
+{
+
+
+
+static const char *SELF_PLAY_USAGE =
+    "usage: self-play -g ID,ID,ID,ID [options]\n"
+    "  -g ID,ID,ID,ID   girl line-up\n"
+    "  -s SEED          seed of the run, default 1\n"
+    "  -n COUNT         number of tables, default 1\n"
+    "  -j THREADS       number of threads, default all cores\n"
+    "  --tonpuu         east round only\n"
+    "  --akadora N      number of red fives, 0, 3, or 4\n"
+    "  --no-rotate      keep the line-up in fixed seats\n";
+
+///
+/// \brief Parse a whole decimal string into 'res'
+///
+static bool selfPlayParseInt(const char *str, long &res)
+{
+    char *end = nullptr;
+    res = std::strtol(str, &end, 10);
+    return *str != '\0' && *end == '\0';
+}
+
+static bool selfPlayParseIds(const char *str, std::array<int, 4> &res)
+{
+    std::string s(str);
+    size_t pos = 0;
+    for (int i = 0; i < 4; i++) {
+        size_t comma = s.find(',', pos);
+        if ((i < 3) != (comma != std::string::npos))
+            return false;
+
+        long id;
+        if (!selfPlayParseInt(s.substr(pos, comma - pos).c_str(), id)
+            || id == static_cast<long>(Girl::Id::CUSTOM))
+            return false;
+
+        res[i] = static_cast<int>(id);
+        pos = comma + 1;
+    }
+
+    return true;
+}
+
+static void selfPlayPrint(std::ostream &out, const SelfPlay::Config &config,
+                          const SelfPlay::Stats &stats, bool final)
+{
+    out << "tables " << stats.tableCt << " rounds " << stats.roundCt << '\n';
+    out << std::fixed << std::setprecision(3);
+    for (int g = 0; g < 4; g++) {
+        double n = stats.tableCt == 0 ? 1.0 : stats.tableCt;
+        out << "  " << config.girlIds[g]
+            << "  rank " << stats.avgRank(g)
+            << "  1st-4th";
+        for (int r = 0; r < 4; r++)
+            out << ' ' << stats.ranks[g][r];
+
+        out << "  points " << stats.points[g] / n
+            << "  score " << stats.scores[g] / n
+            << "  win " << stats.winRate(g)
+            << "  gun " << stats.gunRate(g) << '\n';
+    }
+
+    if (final) {
+        for (size_t i = 0; i < stats.results.size(); i++) {
+            out << "  " << util::stringOf(static_cast<RoundResult>(i))
+                << ' ' << stats.results[i] << '\n';
+        }
+    }
+
+    out << std::flush;
+}
+
+///
+/// \brief Command line front end of SelfPlay
+///
+/// The host program's main() only needs to forward its arguments here.
+/// Aggregated stats are printed to 'out' every SelfPlay::BATCH_CT tables,
+/// the round result histogram with the final ones.
+///
+/// \return Exit status
+///
+int selfPlayCli(int argc, const char *const *argv, std::ostream &out, std::ostream &err)
+{
+    SelfPlay::Config config;
+    bool hasIds = false;
+    long threadCt = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = i + 1 < argc ? argv[i + 1] : nullptr;
+        long num = 0;
+        bool ok = true;
+
+        if (std::strcmp(arg, "--tonpuu") == 0) {
+            config.rule.roundLimit = 4;
+        } else if (std::strcmp(arg, "--no-rotate") == 0) {
+            config.rotate = false;
+        } else if (val == nullptr) {
+            ok = false;
+        } else if (std::strcmp(arg, "-g") == 0) {
+            ok = hasIds = selfPlayParseIds(val, config.girlIds);
+            i++;
+        } else if (std::strcmp(arg, "-s") == 0) {
+            ok = selfPlayParseInt(val, num) && num >= 0;
+            config.seed = static_cast<uint64_t>(num);
+            i++;
+        } else if (std::strcmp(arg, "-n") == 0) {
+            ok = selfPlayParseInt(val, num) && num > 0;
+            config.tableCt = static_cast<int>(num);
+            i++;
+        } else if (std::strcmp(arg, "-j") == 0) {
+            ok = selfPlayParseInt(val, threadCt) && threadCt >= 0;
+            i++;
+        } else if (std::strcmp(arg, "--akadora") == 0) {
+            ok = selfPlayParseInt(val, num) && (num == 0 || num == 3 || num == 4);
+            config.rule.akadora = num == 0 ? TileCount::AKADORA0
+                                           : num == 3 ? TileCount::AKADORA3 : TileCount::AKADORA4;
+            i++;
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            err << "bad argument: " << arg << '\n' << SELF_PLAY_USAGE;
+            return 1;
+        }
+    }
+
+    if (!hasIds) {
+        err << SELF_PLAY_USAGE;
+        return 1;
+    }
+
+    util::ThreadPool pool(static_cast<int>(threadCt));
+    // *INDENT-OFF*
+    SelfPlay::Stats stats = SelfPlay::run(config, pool, [&](const SelfPlay::Stats &s) {
+        if (s.tableCt < config.tableCt)
+            selfPlayPrint(out, config, s, false);
+    });
+    // *INDENT-ON*
+
+    selfPlayPrint(out, config, stats, true);
+    return 0;
+}
+
+
+
+} // namespace saki
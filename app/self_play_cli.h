@@ -0,0 +1,21 @@
+#ifndef SAKI_APP_SELF_PLAY_CLI_H
+#define SAKI_APP_SELF_PLAY_CLI_H
+
+#include <iosfwd>
+
+
+
+namespace saki
+{
+
+
+
+int selfPlayCli(int argc, const char *const *argv, std::ostream &out, std::ostream &err);
+
+
+
+} // namespace saki
+
+
+
+#endif // SAKI_APP_SELF_PLAY_CLI_H
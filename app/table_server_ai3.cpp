@@ -81,14 +81,14 @@ void TableServerAi3::filterUserMsg(const TableMsg &msg, TableServerAi3::MsgBackI
 {
     std::string event = msg.content.event();
     if (event == "activated") {
-        auto view = mServer.table().getView(msg.to);
+        TableViewReal view = mServer.table().getRealView(msg.to);
 
         // must double-check because msg might be expired
-        if (view->myChoices().any()) {
+        if (view.myChoices().any()) {
             if (msg.to.human()) {
                 *it++ = msg.content;
             } else {
-                auto d = mAis[msg.to.index() - 1]->decide(*view);
+                auto d = mAis[msg.to.index() - 1]->decide(view);
                 int nonce = msg.content.args()["nonce"];
                 addBotAction(msg.to, d.action, nonce, it);
             }
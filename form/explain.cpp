@@ -11,7 +11,7 @@ namespace saki
 
 
 
-Explain4::Explain4(const std::vector<T34> &heads, Wait wait, T34 pair,
+Explain4::Explain4(const Heads &heads, Wait wait, T34 pair,
                    int o3Ct, int c3Ct, int o4Ct, int c4Ct)
     : mHeads{heads[0], heads[1], heads[2], heads[3]}
     , mWait(wait)
@@ -23,16 +23,45 @@ Explain4::Explain4(const std::vector<T34> &heads, Wait wait, T34 pair,
 {
     assert(heads.size() == 4);
     assert(0 <= mO3b && mO3b <= mC3b && mC3b <= mO4b && mO4b <= mC4b && mC4b <= 4);
+
+    Features &f = mFeatures; // save typing
+
+    for (int i = 0; i < 4; i++) {
+        T34 t = mHeads[i];
+        f.suits |= 1 << static_cast<int>(t.suit());
+        if (i < mO3b) {
+            uint32_t bit = uint32_t(1) << t.id34();
+            f.seqPairs |= f.seqs & bit;
+            f.seqs |= bit;
+            f.seqOdds ^= bit;
+            f.yaos |= (t.val() == 1 || t.val() == 7) << i;
+        } else {
+            f.x34 |= uint64_t(1) << t.id34();
+            f.yaos |= t.isYao() << i;
+        }
+    }
+
+    f.suits |= 1 << static_cast<int>(pair.suit());
+    f.yaos |= pair.isYao() << 4;
 }
 
-std::vector<Explain4> Explain4::make(const TileCount &count, const util::Stactor<M37, 4> &barks,
-                                     T34 pick, bool ron)
+Explain4::Explain4s Explain4::make(const TileCount &count, const util::Stactor<M37, 4> &barks,
+                                   T34 pick, bool ron)
 {
-    std::vector<Explain4> res;
+    return make(count.explain4(pick), barks, pick, ron);
+}
 
-    std::vector<TileCount::Explain4Closed> expCloseds = count.explain4(pick);
+///
+/// \brief Same as the other overload but with count.explain4(pick) given
+///
+/// Lets ron and tsumo explanations of the same pick share the decomposition.
+///
+Explain4::Explain4s Explain4::make(const TileCount::Explain4Closeds &expCloseds,
+                                   const util::Stactor<M37, 4> &barks, T34 pick, bool ron)
+{
+    Explain4s res;
 
-    for (TileCount::Explain4Closed &exp : expCloseds) {
+    for (TileCount::Explain4Closed exp : expCloseds) {
         assert(exp.sequences.size() + exp.triplets.size() + barks.size() == 4);
 
         // *INDENT-OFF*
@@ -40,13 +69,14 @@ std::vector<Explain4> Explain4::make(const TileCount &count, const util::Stactor
             auto &tar = exp.sequences;
             auto it = std::find_if_not(tar.begin(), tar.end(),
                                        [head](T34 t) { return t < head; });
-            tar.insert(it, head);
+            tar.pushBack(head);
+            std::rotate(it, tar.end() - 1, tar.end());
         };
         // *INDENT-ON*
 
-        std::vector<T34> o3Heads;
-        std::vector<T34> o4Heads;
-        std::vector<T34> c4Heads;
+        Heads o3Heads;
+        Heads o4Heads;
+        Heads c4Heads;
 
         // include barks
         for (const M37 &m : barks) {
@@ -55,14 +85,14 @@ std::vector<Explain4> Explain4::make(const TileCount &count, const util::Stactor
                 insertSequence(m[0]); // keep sequences ordered
                 break;
             case M37::Type::PON:
-                o3Heads.push_back(m[0]);
+                o3Heads.pushBack(m[0]);
                 break;
             case M37::Type::DAIMINKAN:
             case M37::Type::KAKAN:
-                o4Heads.push_back(m[0]);
+                o4Heads.pushBack(m[0]);
                 break;
             case M37::Type::ANKAN:
-                c4Heads.push_back(m[0]);
+                c4Heads.pushBack(m[0]);
                 break;
             }
         }
@@ -90,6 +120,11 @@ T34 Explain4::pair() const
     return mPair;
 }
 
+const Explain4::Features &Explain4::features() const
+{
+    return mFeatures;
+}
+
 Explain4::Iter Explain4::sb() const
 {
     return mHeads.begin();
@@ -180,58 +215,55 @@ int Explain4::numC4() const
     return c4e() - c4b();
 }
 
-void Explain4::mapWait(std::vector<Explain4> &res, T34 pick, bool ron, T34 pair,
-                       const std::vector<T34> &sHeads,
-                       const std::vector<T34> &o3Heads,
-                       const std::vector<T34> &c3Heads,
-                       const std::vector<T34> &o4Heads,
-                       const std::vector<T34> &c4Heads)
+void Explain4::mapWait(Explain4s &res, T34 pick, bool ron, T34 pair,
+                       const Heads &sHeads, const Heads &o3Heads, const Heads &c3Heads,
+                       const Heads &o4Heads, const Heads &c4Heads)
 {
     if (pick == pair) {
-        std::vector<T34> heads(sHeads); // copy
-        heads.insert(heads.end(), o3Heads.begin(), o3Heads.end());
-        heads.insert(heads.end(), c3Heads.begin(), c3Heads.end());
-        heads.insert(heads.end(), o4Heads.begin(), o4Heads.end());
-        heads.insert(heads.end(), c4Heads.begin(), c4Heads.end());
-        res.emplace_back(heads, Wait::ISORIDE, pair,
-                         o3Heads.size(), c3Heads.size(),
-                         o4Heads.size(), c4Heads.size());
+        Heads heads(sHeads); // copy
+        heads.pushBack(o3Heads.range());
+        heads.pushBack(c3Heads.range());
+        heads.pushBack(o4Heads.range());
+        heads.pushBack(c4Heads.range());
+        res.emplaceBack(heads, Wait::ISORIDE, pair,
+                        o3Heads.size(), c3Heads.size(),
+                        o4Heads.size(), c4Heads.size());
     }
 
     for (size_t i = 0; i < c3Heads.size(); i++) {
         if (c3Heads[i] == pick) {
             /// create bi-bump, mind open/closed by 'ron'
-            std::vector<T34> heads(sHeads); // copy
-            heads.insert(heads.end(), o3Heads.begin(), o3Heads.end());
+            Heads heads(sHeads); // copy
+            heads.pushBack(o3Heads.range());
             if (ron) {
-                heads.push_back(c3Heads[i]); // one more open-3
+                heads.pushBack(c3Heads[i]); // one more open-3
                 // filter-out one closed-3
                 for (size_t j = 0; j < c3Heads.size(); j++)
                     if (i != j)
-                        heads.push_back(c3Heads[j]);
+                        heads.pushBack(c3Heads[j]);
             } else {
-                heads.insert(heads.end(), c3Heads.begin(), c3Heads.end());
+                heads.pushBack(c3Heads.range());
             }
 
-            heads.insert(heads.end(), o4Heads.begin(), o4Heads.end());
-            heads.insert(heads.end(), c4Heads.begin(), c4Heads.end());
-            res.emplace_back(heads, Wait::BIBUMP, pair,
-                             o3Heads.size() + ron, c3Heads.size() - ron,
-                             o4Heads.size(), c4Heads.size());
+            heads.pushBack(o4Heads.range());
+            heads.pushBack(c4Heads.range());
+            res.emplaceBack(heads, Wait::BIBUMP, pair,
+                            o3Heads.size() + ron, c3Heads.size() - ron,
+                            o4Heads.size(), c4Heads.size());
         }
     }
 
     for (size_t i = 0; i < sHeads.size(); i++) {
         Wait wait = sHeads[i].waitAsSequence(pick);
         if (wait != Wait::NONE) {
-            std::vector<T34> heads(sHeads); // copy
-            heads.insert(heads.end(), o3Heads.begin(), o3Heads.end());
-            heads.insert(heads.end(), c3Heads.begin(), c3Heads.end());
-            heads.insert(heads.end(), o4Heads.begin(), o4Heads.end());
-            heads.insert(heads.end(), c4Heads.begin(), c4Heads.end());
-            res.emplace_back(heads, wait, pair,
-                             o3Heads.size(), c3Heads.size(),
-                             o4Heads.size(), c4Heads.size());
+            Heads heads(sHeads); // copy
+            heads.pushBack(o3Heads.range());
+            heads.pushBack(c3Heads.range());
+            heads.pushBack(o4Heads.range());
+            heads.pushBack(c4Heads.range());
+            res.emplaceBack(heads, wait, pair,
+                            o3Heads.size(), c3Heads.size(),
+                            o4Heads.size(), c4Heads.size());
         }
     }
 }
@@ -4,7 +4,7 @@
 #include "hand.h"
 
 #include <array>
-#include <vector>
+#include <cstdint>
 
 
 
@@ -27,15 +27,44 @@ namespace saki
 class Explain4
 {
 public:
-    explicit Explain4(const std::vector<T34> &heads, Wait wait, T34 pair,
+    using Heads = util::Stactor<T34, 4>;
+
+    ///
+    /// At most 1 + 4 per closed explanation, and no more than 12 in total
+    /// were found. testExplain4() checks the bound over all one-suit complete hands
+    ///
+    using Explain4s = util::Stactor<Explain4, 16>;
+
+    ///
+    /// \brief Packed summary of the heads and the pair
+    ///
+    /// Lets yaku checks be done by a few mask operations
+    /// instead of scanning the heads over and over.
+    ///
+    struct Features
+    {
+        uint64_t x34 = 0; ///< Triplet and quad heads, bit by id34
+        uint32_t seqs = 0; ///< Sequence heads present, bit by id34
+        uint32_t seqPairs = 0; ///< Sequence heads appearing at least twice
+        uint32_t seqOdds = 0; ///< Sequence heads appearing odd times
+        uint8_t suits = 0; ///< Suits of the heads and the pair, bit by Suit
+        uint8_t yaos = 0; ///< Bit i if heads()[i] has a yao tile, bit 4 for the pair
+    };
+
+    static const uint8_t ALL_YAOS = 0x1F;
+
+    explicit Explain4(const Heads &heads, Wait wait, T34 pair,
                       int o3Ct, int c3Ct, int o4Ct, int c4Ct);
 
-    static std::vector<Explain4> make(const TileCount &count, const util::Stactor<M37, 4> &barks,
-                                      T34 pick, bool ron);
+    static Explain4s make(const TileCount &count, const util::Stactor<M37, 4> &barks,
+                          T34 pick, bool ron);
+    static Explain4s make(const TileCount::Explain4Closeds &expCloseds,
+                          const util::Stactor<M37, 4> &barks, T34 pick, bool ron);
 
     const std::array<T34, 4> &heads() const;
     Wait wait() const;
     T34 pair() const;
+    const Features &features() const;
 
     using Iter = std::array<T34, 4>::const_iterator;
 
@@ -60,10 +89,9 @@ public:
     int numC4() const;
 
 private:
-    static void mapWait(std::vector<Explain4> &res, T34 pick, bool ron, T34 pair,
-                        const std::vector<T34> &sHeads,
-                        const std::vector<T34> &o3Heads, const std::vector<T34> &c3Heads,
-                        const std::vector<T34> &o4Heads, const std::vector<T34> &c4Heads);
+    static void mapWait(Explain4s &res, T34 pick, bool ron, T34 pair,
+                        const Heads &sHeads, const Heads &o3Heads, const Heads &c3Heads,
+                        const Heads &o4Heads, const Heads &c4Heads);
 
 private:
     std::array<T34, 4> mHeads;
@@ -73,6 +101,7 @@ private:
     int mC3b;
     int mO4b;
     int mC4b;
+    Features mFeatures;
 };
 
 
@@ -3,7 +3,6 @@
 #include "../util/misc.h"
 #include "../util/rand.h"
 
-#include <numeric>
 #include <sstream>
 
 
@@ -51,6 +50,83 @@ std::array<const char *, NUM_YAKUS> YAKU_UNIQUES {
 
 
 
+namespace
+{
+
+
+
+///
+/// \brief Han of each yaku, except yakumans
+///
+constexpr std::array<int, NUM_YAKUS> makeYakuHans()
+{
+    std::array<int, NUM_YAKUS> res {};
+
+    // *** SYNC with enum Yaku ***
+    const std::array<std::pair<int, int>, 5> lasts {
+        std::pair<int, int> { Yaku::HCTYC_K, 1 },
+        std::pair<int, int> { Yaku::JCTYC_K, 2 },
+        std::pair<int, int> { Yaku::RPK, 3 },
+        std::pair<int, int> { Yaku::CIS_K, 5 },
+        std::pair<int, int> { Yaku::CIS, 6 },
+    };
+
+    int i = 0;
+    for (const auto &last : lasts)
+        while (i <= last.first)
+            res[i++] = last.second;
+
+    return res;
+}
+
+constexpr std::array<int, NUM_YAKUS> YAKU_HANS = makeYakuHans();
+
+///
+/// \brief Yakus of each han value as bits, indexed by han
+///
+constexpr std::array<uint64_t, 7> makeHanMasks()
+{
+    std::array<uint64_t, 7> res {};
+    for (int i = 0; i < NUM_YAKUS; i++)
+        res[YAKU_HANS[i]] |= uint64_t(1) << i;
+
+    return res;
+}
+
+constexpr std::array<uint64_t, 7> HAN_MASKS = makeHanMasks();
+
+// masks over Explain4::Features
+const uint8_t NUM_SUITS = 0b00111;
+const uint8_t Z_SUITS = 0b11000;
+const uint64_t F_MASK = uint64_t(0b1111) << 27;
+const uint64_t Y_MASK = uint64_t(0b111) << 31;
+const uint32_t SAME_VAL_MASK = (1 << 0) | (1 << 9) | (1 << 18); // m, p, and s of a value
+const uint32_t ITTSUU_MASK = (1 << 0) | (1 << 3) | (1 << 6); // 1, 4, and 7 of a suit
+
+static_assert(YAKU_HANS[Yaku::RC] == 1 && YAKU_HANS[Yaku::DBRRC] == 2
+              && YAKU_HANS[Yaku::HIS] == 3 && YAKU_HANS[Yaku::CIS_K] == 5
+              && YAKU_HANS[Yaku::CIS] == 6 && YAKU_HANS[Yaku::KKSMS] == 0,
+              "han table out of sync with enum Yaku");
+
+
+
+} // namespace
+
+
+
+///
+/// \brief Shape rules checked by calcYaku4(), in order
+///
+/// A house-rule yaku on a 4-meld shape can be added by appending here.
+///
+constexpr std::array<Form::Yaku4Rule, 10> Form::YAKU4_RULES {
+    &Form::checkAge4, &Form::checkPinfu4, &Form::checkDye4, &Form::checkCup4,
+    &Form::checkYakuhai4, &Form::checkIttsuu4, &Form::checkSanshoku4,
+    &Form::checkX34s4, &Form::checkSanshokudoukou4, &Form::checkShousangen,
+};
+
+
+
 Form::Form(const Hand &ready, const T37 &pick, const FormCtx &ctx, const Rule &rule,
            const util::Stactor<T37, 5> &drids, const util::Stactor<T37, 5> &urids)
     : mDealerWin(ctx.selfWind == 1)
@@ -91,6 +167,83 @@ Form::Form(const Hand &full, const FormCtx &ctx, const Rule &rule,
     }
 }
 
+///
+/// \brief Construct a ron or tsumo form with the winning type and the
+///        closed decompositions of 'ready' plus 'pick' given
+/// \param expCloseds Same as ready.closed().explain4(pick), used only by F4
+///
+Form::Form(const Hand &ready, const T37 &pick, bool ron, Type type,
+           const TileCount::Explain4Closeds &expCloseds,
+           const FormCtx &ctx, const Rule &rule,
+           const util::Stactor<T37, 5> &drids, const util::Stactor<T37, 5> &urids)
+    : mDealerWin(ctx.selfWind == 1)
+    , mRon(ron)
+    , mExtraRound(ctx.extraRound)
+{
+    initDora(drids, urids, ready, pick);
+
+    switch (type) {
+    case Type::F13:
+        init13(ctx, ready.closed(), pick);
+        break;
+    case Type::F4:
+        init4(ctx, rule, ready, pick, Explain4::make(expCloseds, ready.barks(), pick, mRon));
+        break;
+    case Type::F7:
+        init7(ctx, rule, ready.closed());
+        break;
+    }
+}
+
+///
+/// \brief Construct a skeleton with no type, yaku, or dora
+///
+/// Only used to call the yaku checks, which depend on the ron-ness
+///
+Form::Form(bool ron, const FormCtx &ctx)
+    : mType(Type::F4)
+    , mDealerWin(ctx.selfWind == 1)
+    , mRon(ron)
+    , mExtraRound(ctx.extraRound)
+    , mDora(0)
+    , mUradora(0)
+    , mAkadora(0)
+{
+}
+
+///
+/// \brief Decide hasYaku() of a 4-meld form without scoring it
+///
+/// Context yakus and yakumans hold for every explanation.
+/// Otherwise, when only some explanations have a yaku, it depends on
+/// which explanation scores the most, and the result is UNSURE.
+///
+Form::YakuGuess Form::guessYaku4(const FormCtx &ctx, const Rule &rule,
+                                 const Hand &hand, const T37 &last) const
+{
+    Yakus ctxYakus;
+    checkPick(ctxYakus, ctx);
+    checkRiichi(ctxYakus, ctx, rule);
+    checkTsumo(ctxYakus, hand.isMenzen());
+    if (ctxYakus.any())
+        return YakuGuess::YES;
+
+    Explain4::Explain4s exps = Explain4::make(hand.closed(), hand.barks(), last, mRon);
+    int yakuCt = 0;
+    for (const Explain4 &exp : exps) {
+        if (calcYakuman4(ctx, exp, hand.closed(), last).any())
+            return YakuGuess::YES;
+
+        if (calcYaku4(ctx, rule, hand.isMenzen(), exp).any())
+            yakuCt++;
+    }
+
+    if (yakuCt == 0)
+        return YakuGuess::NO;
+
+    return yakuCt == static_cast<int>(exps.size()) ? YakuGuess::YES : YakuGuess::UNSURE;
+}
+
 bool Form::isPrototypalYakuman() const
 {
     return mYakuman;
@@ -373,10 +526,14 @@ void Form::init13(const FormCtx &ctx, const TileCount &ready, T34 last)
 
 void Form::init4(const FormCtx &ctx, const Rule &rule,
                  const Hand &hand, const T37 &last)
+{
+    init4(ctx, rule, hand, last, Explain4::make(hand.closed(), hand.barks(), last, mRon));
+}
+
+void Form::init4(const FormCtx &ctx, const Rule &rule, const Hand &hand, const T37 &last,
+                 const Explain4::Explain4s &exps)
 {
     mType = Type::F4;
-    std::vector<Explain4> exps = Explain4::make(hand.closed(), hand.barks(),
-                                                last, mRon);
 
     for (const Explain4 &exp : exps) {
         Yakus ykms = calcYakuman4(ctx, exp, hand.closed(), last);
@@ -512,38 +669,18 @@ void Form::checkTsumo(Form::Yakus &ys, bool menzen) const
         ys.set(Yaku::MZCTMH);
 }
 
-void Form::checkAge4(Form::Yakus &ys, const Explain4 &exp, bool menzen) const
+void Form::checkAge4(Form::Yakus &ys, const Yaku4Args &args) const
 {
-    // init by pair's age
-    bool all = exp.pair().isYao();
-    bool none = !exp.pair().isYao();
-    bool hasZ = exp.pair().isZ();
-
-    for (auto it = exp.sb(); it != exp.se(); ++it) {
-        bool yao = it->val() == 1 || it->val() == 7;
-        all = all && yao;
-        none = none && !yao;
-        if (!all && !none) // mixture, no more hope
-            return;
-    }
+    const Explain4::Features &f = args.exp.features();
+    bool hasZ = f.suits & Z_SUITS;
 
-    for (auto it = exp.x34b(); it != exp.x34e(); ++it) {
-        bool yao = it->isYao();
-        all = all && yao;
-        none = none && !yao;
-        if (!all && !none) // mixture, no more hope
-            return;
-
-        hasZ = hasZ || it->isZ();
-    }
-
-    if (none) {
+    if (f.yaos == 0) {
         ys.set(Yaku::TYC);
-    } else if (all) {
-        if (exp.numX34() == 4) {
+    } else if (f.yaos == Explain4::ALL_YAOS) {
+        if (args.exp.numX34() == 4) {
             assert(hasZ); // yakuman already checked
             ys.set(Yaku::HRT); // implies toitoi but does not care
-        } else if (menzen) {
+        } else if (args.menzen) {
             ys.set(hasZ ? Yaku::HCTYC : Yaku::JCTYC);
         } else {
             ys.set(hasZ ? Yaku::HCTYC_K : Yaku::JCTYC_K);
@@ -551,167 +688,123 @@ void Form::checkAge4(Form::Yakus &ys, const Explain4 &exp, bool menzen) const
     }
 }
 
-void Form::checkPinfu4(Form::Yakus &ys, const FormCtx &ctx,
-                       const Explain4 &exp, bool menzen) const
+void Form::checkPinfu4(Form::Yakus &ys, const Yaku4Args &args) const
 {
-    if (menzen && exp.numS() == 4 && exp.wait() == Wait::BIFACE
-        && !exp.pair().isYakuhai(ctx.selfWind, ctx.roundWind)) {
+    if (args.menzen && args.exp.numS() == 4 && args.exp.wait() == Wait::BIFACE
+        && !args.exp.pair().isYakuhai(args.ctx.selfWind, args.ctx.roundWind)) {
         ys.set(Yaku::PF);
     }
 }
 
-void Form::checkDye4(Form::Yakus &ys, const Explain4 &exp, bool menzen) const
+void Form::checkDye4(Form::Yakus &ys, const Yaku4Args &args) const
 {
-    bool hasZ = exp.pair().isZ();
-    std::array<bool, 3> hasNum { false, false, false };
-    if (exp.pair().isNum())
-        hasNum[static_cast<int>(exp.pair().suit())] = true;
+    const Explain4::Features &f = args.exp.features();
+    bool hasZ = f.suits & Z_SUITS;
 
-    for (T34 t : exp.heads()) {
-        if (t.isZ())
-            hasZ = true;
-        else
-            hasNum[static_cast<int>(t.suit())] = true;
-    }
-
-    if (std::accumulate(hasNum.begin(), hasNum.end(), 0) == 1) {
-        if (menzen)
+    if (__builtin_popcount(f.suits & NUM_SUITS) == 1) {
+        if (args.menzen)
             ys.set(hasZ ? Yaku::HIS : Yaku::CIS);
         else
             ys.set(hasZ ? Yaku::HIS_K : Yaku::CIS_K);
     }
 }
 
-void Form::checkCup4(Form::Yakus &ys, const Explain4 &exp, bool menzen) const
+void Form::checkCup4(Form::Yakus &ys, const Yaku4Args &args) const
 {
-    if (!menzen)
+    if (!args.menzen)
         return;
 
-    if (exp.numS() == 4
-        && exp.heads().at(0) == exp.heads().at(1)
-        && exp.heads().at(2) == exp.heads().at(3)) {
+    const Explain4::Features &f = args.exp.features();
+
+    if (args.exp.numS() == 4 && f.seqOdds == 0)
         ys.set(Yaku::RPK);
-    } else if (exp.numS() >= 2) {
-        for (auto it = exp.sb(); it + 1 != exp.se(); ++it) {
-            if (*it == *(it + 1)) {
-                ys.set(Yaku::IPK);
-                break;
-            }
-        }
-    }
+    else if (f.seqPairs != 0)
+        ys.set(Yaku::IPK);
 }
 
-void Form::checkYakuhai4(Form::Yakus &ys, const FormCtx &ctx, const Explain4 &exp) const
+void Form::checkYakuhai4(Form::Yakus &ys, const Yaku4Args &args) const
 {
-    for (auto it = exp.x34b(); it != exp.x34e(); ++it) {
-        if (it->suit() == Suit::Y) {
-            const std::array<Yaku, 3> Y { Yaku::YKH1Y, Yaku::YKH2Y, Yaku::YKH3Y };
-            ys.set(Y.at(it->val() - 1));
-        } else {
-            if (it->suit() == Suit::F && it->val() == ctx.selfWind) {
-                const std::array<Yaku, 4> J {
-                    Yaku::JKZ1F, Yaku::JKZ2F, Yaku::JKZ3F, Yaku::JKZ4F,
-                };
-                ys.set(J.at(it->val() - 1));
-            }
-
-            if (it->suit() == Suit::F && it->val() == ctx.roundWind) {
-                const std::array<Yaku, 4> B {
-                    Yaku::BKZ1F, Yaku::BKZ2F, Yaku::BKZ3F, Yaku::BKZ4F,
-                };
-                ys.set(B.at(it->val() - 1));
-            }
-        }
+    uint64_t x34 = args.exp.features().x34;
+    // *INDENT-OFF*
+    auto has = [x34](Suit suit, int val) {
+        return (x34 >> T34(suit, val).id34()) & 1;
+    };
+    // *INDENT-ON*
+
+    const std::array<Yaku, 3> Y { Yaku::YKH1Y, Yaku::YKH2Y, Yaku::YKH3Y };
+    for (int v = 1; v <= 3; v++)
+        if (has(Suit::Y, v))
+            ys.set(Y[v - 1]);
+
+    int self = args.ctx.selfWind;
+    if (1 <= self && self <= 4 && has(Suit::F, self)) {
+        const std::array<Yaku, 4> J {
+            Yaku::JKZ1F, Yaku::JKZ2F, Yaku::JKZ3F, Yaku::JKZ4F,
+        };
+        ys.set(J[self - 1]);
+    }
+
+    int round = args.ctx.roundWind;
+    if (1 <= round && round <= 4 && has(Suit::F, round)) {
+        const std::array<Yaku, 4> B {
+            Yaku::BKZ1F, Yaku::BKZ2F, Yaku::BKZ3F, Yaku::BKZ4F,
+        };
+        ys.set(B[round - 1]);
     }
 }
 
-void Form::checkIttsuu4(Form::Yakus &ys, const Explain4 &exp, bool menzen) const
+void Form::checkIttsuu4(Form::Yakus &ys, const Yaku4Args &args) const
 {
-    // *INDENT-OFF*
-    auto check = [](T34 l, T34 m, T34 r) -> bool {
-        return l.suit() == r.suit() && l.val() == 1 && m.val() == 4 && r.val() == 7;
-    };
-    // *INDENT-ON*
+    uint32_t seqs = args.exp.features().seqs;
 
-    const auto &h = exp.heads(); // save typing
-
-    if (exp.numS() == 3) {
-        if (check(h[0], h[1], h[2]))
-            ys.set(menzen ? Yaku::IKTK : Yaku::IKTK_K);
-    } else if (exp.numS() == 4) {
-        if (check(h[0], h[1], h[2])
-            || check(h[0], h[1], h[3])
-            || check(h[0], h[2], h[3])
-            || check(h[1], h[2], h[3]))
-            ys.set(menzen ? Yaku::IKTK : Yaku::IKTK_K);
+    for (int s = 0; s < 3; s++) {
+        if (((seqs >> (9 * s)) & ITTSUU_MASK) == ITTSUU_MASK) {
+            ys.set(args.menzen ? Yaku::IKTK : Yaku::IKTK_K);
+            return;
+        }
     }
 }
 
-void Form::checkSanshoku4(Form::Yakus &ys, const Explain4 &exp, bool menzen) const
+void Form::checkSanshoku4(Form::Yakus &ys, const Yaku4Args &args) const
 {
-    // *INDENT-OFF*
-    auto check = [](T34 l, T34 m, T34 r) -> bool {
-        // inequality is transitive when it is sorted
-        return l.suit() != m.suit() && m.suit() != r.suit()
-                && l.val() == m.val() && m.val() == r.val();
-    };
-    // *INDENT-ON*
+    uint32_t seqs = args.exp.features().seqs;
 
-    const auto &h = exp.heads(); // save typing
-
-    if (exp.numS() == 3) {
-        if (check(h[0], h[1], h[2]))
-            ys.set(menzen ? Yaku::SSKDJ : Yaku::SSKDJ_K);
-    } else if (exp.numS() == 4) {
-        if (check(h[0], h[1], h[2])
-            || check(h[0], h[1], h[3])
-            || check(h[0], h[2], h[3])
-            || check(h[1], h[2], h[3]))
-            ys.set(menzen ? Yaku::SSKDJ : Yaku::SSKDJ_K);
+    for (int v = 0; v < 7; v++) {
+        if (((seqs >> v) & SAME_VAL_MASK) == SAME_VAL_MASK) {
+            ys.set(args.menzen ? Yaku::SSKDJ : Yaku::SSKDJ_K);
+            return;
+        }
     }
 }
 
-void Form::checkX34s4(Form::Yakus &ys, const Explain4 &exp) const
+void Form::checkX34s4(Form::Yakus &ys, const Yaku4Args &args) const
 {
-    if (exp.numX34() == 4)
+    if (args.exp.numX34() == 4)
         ys.set(Yaku::TTH);
 
-    if (exp.numC3() + exp.numC4() == 3)
+    if (args.exp.numC3() + args.exp.numC4() == 3)
         ys.set(Yaku::S3AK);
 
-    if (exp.numO4() + exp.numC4() == 3)
+    if (args.exp.numO4() + args.exp.numC4() == 3)
         ys.set(Yaku::S3KT);
 }
 
-void Form::checkSanshokudoukou4(Form::Yakus &ys, const Explain4 &exp) const
+void Form::checkSanshokudoukou4(Form::Yakus &ys, const Yaku4Args &args) const
 {
-    // *INDENT-OFF*
-    auto check = [](T34 l, T34 m, T34 r) -> bool {
-        // suits must different (except vertical overflow bug)
-        return l.isNum() && m.isNum() && r.isNum()
-                && l.val() == m.val() && m.val() == r.val();
-    };
-    // *INDENT-ON*
-
-    const auto &h = exp.heads(); // save typing
+    uint64_t x34 = args.exp.features().x34;
 
-    if (exp.numX34() == 3) {
-        if (check(h[1], h[2], h[3])) // X34 lays from the back
-            ys.set(Yaku::SSKDK);
-    } else if (exp.numX34() == 4) {
-        if (check(h[0], h[1], h[2])
-            || check(h[0], h[1], h[3])
-            || check(h[0], h[2], h[3])
-            || check(h[1], h[2], h[3]))
+    for (int v = 0; v < 9; v++) {
+        if (((x34 >> v) & SAME_VAL_MASK) == SAME_VAL_MASK) {
             ys.set(Yaku::SSKDK);
+            return;
+        }
     }
 }
 
-void Form::checkShousangen(Form::Yakus &ys, const Explain4 &exp) const
+void Form::checkShousangen(Form::Yakus &ys, const Yaku4Args &args) const
 {
-    int ct = std::count_if(exp.x34b(), exp.x34e(),
-                           [](T34 t) { return t.suit() == Suit::Y; });
-    if (exp.pair().suit() == Suit::Y && ct == 2)
+    uint64_t x34 = args.exp.features().x34;
+    if (args.exp.pair().suit() == Suit::Y && __builtin_popcountll(x34 & Y_MASK) == 2)
         ys.set(Yaku::SSG);
 }
 
@@ -727,8 +820,8 @@ Form::Yakus Form::calcYakuman4(const FormCtx &ctx, const Explain4 &exp,
         anyWait = true;
     }
 
-    const std::array<T34, 4> &heads = exp.heads();
-    if (util::all(heads, [](T34 h) { return h.isZ(); }) && exp.pair().isZ())
+    const Explain4::Features &f = exp.features();
+    if ((f.suits & NUM_SUITS) == 0)
         res.set(Yaku::TIS);
 
     // Suuankou
@@ -736,22 +829,18 @@ Form::Yakus Form::calcYakuman4(const FormCtx &ctx, const Explain4 &exp,
         res.set(exp.wait() == Wait::ISORIDE || anyWait ? Yaku::S4AK_A : Yaku::S4AK);
 
     // Daisangen
-    int yCt = std::count_if(exp.x34b(), exp.x34e(),
-                            [](T34 t) { return t.suit() == Suit::Y; });
-    if (yCt == 3)
+    if (__builtin_popcountll(f.x34 & Y_MASK) == 3)
         res.set(Yaku::DSG);
 
     // Shousuushii Daisuushii
-    int fCt = std::count_if(exp.x34b(), exp.x34e(),
-                            [](T34 t) { return t.suit() == Suit::F; });
+    int fCt = __builtin_popcountll(f.x34 & F_MASK);
     if (fCt == 4)
         res.set(Yaku::DSS);
     else if (fCt == 3 && exp.pair().suit() == Suit::F)
         res.set(Yaku::SSS);
 
     // Chinroutou
-    if (exp.numX34() == 4 && util::all(heads, [](T34 t) { return t.isNum19(); })
-        && exp.pair().isNum19())
+    if (exp.numX34() == 4 && (f.suits & Z_SUITS) == 0 && f.yaos == Explain4::ALL_YAOS)
         res.set(Yaku::CRT);
 
     // Ryuuiisou
@@ -806,16 +895,10 @@ Form::Yakus Form::calcYaku4(const FormCtx &ctx, const Rule &rule,
     checkPick(res, ctx);
     checkRiichi(res, ctx, rule);
     checkTsumo(res, menzen);
-    checkAge4(res, exp, menzen);
-    checkPinfu4(res, ctx, exp, menzen);
-    checkDye4(res, exp, menzen);
-    checkCup4(res, exp, menzen);
-    checkYakuhai4(res, ctx, exp);
-    checkIttsuu4(res, exp, menzen);
-    checkSanshoku4(res, exp, menzen);
-    checkX34s4(res, exp);
-    checkSanshokudoukou4(res, exp);
-    checkShousangen(res, exp);
+
+    Yaku4Args args { ctx, exp, menzen };
+    for (Yaku4Rule rule4 : YAKU4_RULES)
+        (this->*rule4)(res, args);
 
     return res;
 }
@@ -862,22 +945,9 @@ int Form::calcHan(const Yakus &ys) const
 {
     int res = 0;
 
-    int i = 0;
-
-    while (i <= Yaku::HCTYC_K)
-        res += ys[i++] * 1;
-
-    while (i <= Yaku::JCTYC_K)
-        res += ys[i++] * 2;
-
-    while (i <= Yaku::RPK)
-        res += ys[i++] * 3;
-
-    while (i <= Yaku::CIS_K)
-        res += ys[i++] * 5;
-
-    while (i <= Yaku::CIS)
-        res += ys[i++] * 6;
+    uint64_t bits = ys.to_ullong();
+    for (int han = 1; han < static_cast<int>(HAN_MASKS.size()); han++)
+        res += han * __builtin_popcountll(bits & HAN_MASKS[han]);
 
     res += mDora + mUradora + mAkadora;
 
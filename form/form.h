@@ -11,7 +11,7 @@ namespace saki
 
 
 enum Yaku {
-    // *** SYNC with Form::calcHan() ***
+    // *** SYNC with YAKU_HANS ***
     // *** SYNC with YAKU_STRS and Form::spell() ***
     RC, IPT, MZCTMH, TYC, PF,
     YKH1Y, YKH2Y, YKH3Y,
@@ -36,6 +36,8 @@ enum ManganType { HR, MG, HNM, BM, SBM, KZEYKM };
 
 extern std::array<const char *, NUM_YAKUS> YAKU_STRS;
 
+static_assert(NUM_YAKUS <= 64, "Form::calcHan() masks yakus in 64 bits");
+
 class Form
 {
 public:
@@ -72,8 +74,42 @@ public:
     std::string charge() const;
 
 private:
+    friend class WaitTable;
+    friend class LazyForm;
+
+    ///
+    /// \brief Result of deciding hasYaku() without scoring
+    ///
+    enum class YakuGuess { NO, YES, UNSURE };
+
+    ///
+    /// \brief Arguments shared by all the 4-meld shape rules
+    ///
+    struct Yaku4Args
+    {
+        const FormCtx &ctx;
+        const Explain4 &exp;
+        bool menzen;
+    };
+
+    using Yaku4Rule = void (Form::*)(Yakus &ys, const Yaku4Args &args) const;
+
+    static const std::array<Yaku4Rule, 10> YAKU4_RULES;
+
+    Form(const Hand &ready, const T37 &pick, bool ron, Type type,
+         const TileCount::Explain4Closeds &expCloseds,
+         const FormCtx &ctx, const Rule &rule,
+         const util::Stactor<T37, 5> &drids, const util::Stactor<T37, 5> &urids);
+
+    Form(bool ron, const FormCtx &ctx);
+
+    YakuGuess guessYaku4(const FormCtx &ctx, const Rule &rule,
+                         const Hand &hand, const T37 &last) const;
+
     void init13(const FormCtx &ctx, const TileCount &ready, T34 last);
     void init4(const FormCtx &ctx, const Rule &rule, const Hand &hand, const T37 &last);
+    void init4(const FormCtx &ctx, const Rule &rule, const Hand &hand, const T37 &last,
+               const Explain4::Explain4s &exps);
     void init7(const FormCtx &ctx, const Rule &rule, const TileCount &ready);
 
     void init7Dye(const TileCount &ready);
@@ -86,16 +122,16 @@ private:
     void checkPick(Yakus &ys, const FormCtx &ctx) const;
     void checkRiichi(Yakus &ys, const FormCtx &ctx, const Rule &rule) const;
     void checkTsumo(Yakus &ys, bool menzen) const;
-    void checkAge4(Yakus &ys, const Explain4 &exp, bool menzen) const;
-    void checkPinfu4(Yakus &ys, const FormCtx &ctx, const Explain4 &exp, bool menzen) const;
-    void checkDye4(Yakus &ys, const Explain4 &exp, bool menzen) const;
-    void checkCup4(Yakus &ys, const Explain4 &exp, bool menzen) const;
-    void checkYakuhai4(Yakus &ys, const FormCtx &ctx, const Explain4 &exp) const;
-    void checkIttsuu4(Yakus &ys, const Explain4 &exp, bool menzen) const;
-    void checkSanshoku4(Yakus &ys, const Explain4 &exp, bool menzen) const;
-    void checkX34s4(Yakus &ys, const Explain4 &exp) const;
-    void checkSanshokudoukou4(Yakus &ys, const Explain4 &exp) const;
-    void checkShousangen(Yakus &ys, const Explain4 &exp) const;
+    void checkAge4(Yakus &ys, const Yaku4Args &args) const;
+    void checkPinfu4(Yakus &ys, const Yaku4Args &args) const;
+    void checkDye4(Yakus &ys, const Yaku4Args &args) const;
+    void checkCup4(Yakus &ys, const Yaku4Args &args) const;
+    void checkYakuhai4(Yakus &ys, const Yaku4Args &args) const;
+    void checkIttsuu4(Yakus &ys, const Yaku4Args &args) const;
+    void checkSanshoku4(Yakus &ys, const Yaku4Args &args) const;
+    void checkX34s4(Yakus &ys, const Yaku4Args &args) const;
+    void checkSanshokudoukou4(Yakus &ys, const Yaku4Args &args) const;
+    void checkShousangen(Yakus &ys, const Yaku4Args &args) const;
 
     Yakus calcYakuman4(const FormCtx &ctx, const Explain4 &exp,
                        const TileCount &closed, const T37 &last) const;
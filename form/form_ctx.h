@@ -18,6 +18,19 @@ struct FormCtx
     int roundWind = 0; // not any wind
     int selfWind = 0; // not any wind
     int extraRound = 0;
+
+    bool operator==(const FormCtx &that) const
+    {
+        return ippatsu == that.ippatsu && bless == that.bless
+               && duringKan == that.duringKan && emptyMount == that.emptyMount
+               && riichi == that.riichi && roundWind == that.roundWind
+               && selfWind == that.selfWind && extraRound == that.extraRound;
+    }
+
+    bool operator!=(const FormCtx &that) const
+    {
+        return !(*this == that);
+    }
 };
 
 
@@ -15,8 +15,8 @@ FormGb::FormGb(const Hand &ready, const T37 &pick, const FormCtx &ctx, bool juez
         init13(ctx);
     } else {
         if (ready.peekPickStep4(pick) == -1) {
-            std::vector<Explain4> exps = Explain4::make(ready.closed(), ready.barks(),
-                                                        pick, mDianpao);
+            Explain4::Explain4s exps = Explain4::make(ready.closed(), ready.barks(),
+                                                      pick, mDianpao);
 
             for (const Explain4 &exp : exps) {
                 Fans fs = calcFansF4(ctx, ready, pick, exp, juezhang);
@@ -50,8 +50,8 @@ FormGb::FormGb(const Hand &full, const FormCtx &ctx, bool juezhang)
         init13(ctx);
     } else {
         if (full.step4() == -1) {
-            std::vector<Explain4> exps = Explain4::make(full.closed(), full.barks(),
-                                                        full.drawn(), mDianpao);
+            Explain4::Explain4s exps = Explain4::make(full.closed(), full.barks(),
+                                                      full.drawn(), mDianpao);
 
             for (const Explain4 &exp : exps) {
                 Fans fs = calcFansF4(ctx, full, full.drawn(), exp, juezhang);
@@ -850,7 +850,7 @@ void FormGb::checkV1F4(FormGb::Fans &res, const Explain4 &exp,
         res.push_back(Fan::MG1);
 
     // Queyimen
-    std::array<bool, 3> hasSuits { false, false, false };
+    std::array<bool, 5> hasSuits { false, false, false, false, false };
     hasSuits[static_cast<int>(exp.pair().suit())] = true;
     for (T34 t : exp.heads())
         hasSuits[static_cast<int>(t.suit())] = true;
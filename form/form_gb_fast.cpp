@@ -0,0 +1,952 @@
+#include "form_gb_fast.h"
+#include "../util/misc.h"
+
+#include <algorithm>
+#include <bitset>
+
+
+
+namespace saki
+{
+
+
+
+namespace
+{
+
+
+
+using FanSet = std::bitset<Fan::NUM_FANS>;
+
+constexpr std::array<int, Fan::NUM_FANS> makeFanValues()
+{
+    std::array<int, Fan::NUM_FANS> res {};
+
+    // *** SYNC with enum Fan ***
+    const std::array<std::pair<int, int>, 13> lasts {
+        std::pair<int, int> { Fan::SSY88, 88 },
+        std::pair<int, int> { Fan::YSSLH64, 64 },
+        std::pair<int, int> { Fan::YSSJG48, 48 },
+        std::pair<int, int> { Fan::HYJ32, 32 },
+        std::pair<int, int> { Fan::QX24, 24 },
+        std::pair<int, int> { Fan::SAK16, 16 },
+        std::pair<int, int> { Fan::SFK12, 12 },
+        std::pair<int, int> { Fan::QGH8, 8 },
+        std::pair<int, int> { Fan::SJK6, 6 },
+        std::pair<int, int> { Fan::MAG5, 5 },
+        std::pair<int, int> { Fan::HJZ4, 4 },
+        std::pair<int, int> { Fan::DY2, 2 },
+        std::pair<int, int> { Fan::ZM1, 1 },
+    };
+
+    int i = 0;
+    for (const auto &last : lasts)
+        while (i <= last.first)
+            res[i++] = last.second;
+
+    return res;
+}
+
+constexpr std::array<int, Fan::NUM_FANS> FAN_VALUES = makeFanValues();
+
+FanSet fanSet(std::initializer_list<Fan> fans)
+{
+    FanSet res;
+    for (Fan f : fans)
+        res.set(f);
+
+    return res;
+}
+
+// *INDENT-OFF*
+const FanSet IMPLY_QYS = fanSet({ Fan::JLBD88, Fan::YSSLH64 });
+const FanSet IMPLY_HYJ = fanSet({ Fan::QYJ64, Fan::ZYS64 });
+const FanSet IMPLY_PPH = fanSet({ Fan::DSX88, Fan::SG88, Fan::QYJ64, Fan::ZYS64, Fan::SAK64,
+                                  Fan::YSSJG48, Fan::HYJ32, Fan::QSK24 });
+const FanSet IMPLY_SAG = fanSet({ Fan::SG88, Fan::SG32, Fan::SAK2 });
+const FanSet IMPLY_GANG = fanSet({ Fan::SG88, Fan::SG32 }); // mag, smg, ag, mg
+const FanSet IMPLY_QDY = fanSet({ Fan::QYJ64, Fan::ZYS64, Fan::HYJ32 });
+const FanSet IMPLY_BQR = fanSet({ Fan::JLBD88, Fan::SAK64 });
+const FanSet IMPLY_MQQ = fanSet({ Fan::JLBD88, Fan::SAK64, Fan::BQR4 });
+const FanSet IMPLY_PH = fanSet({ Fan::YSSLH64, Fan::SSSLH16 });
+const FanSet IMPLY_DY = fanSet({ Fan::QSK24, Fan::QZ24, Fan::QDW16 });
+const FanSet IMPLY_YBG = fanSet({ Fan::YSSLH64, Fan::YSSTS48, Fan::YSSTS24 });
+const FanSet IMPLY_XXF = fanSet({ Fan::SSSLH16, Fan::SSSTS8 });
+const FanSet IMPLY_LL = fanSet({ Fan::QL16 });
+const FanSet IMPLY_LSF = fanSet({ Fan::YSSLH64, Fan::QL16, Fan::SSSLH16 });
+const FanSet IMPLY_YJK = fanSet({ Fan::DSX88, Fan::JLBD88, Fan::QYJ64, Fan::ZYS64, Fan::HYJ32 });
+const FanSet IMPLY_QYM = fanSet({ Fan::XSY64, Fan::XSX64, Fan::YSSTS48, Fan::YSSJG48,
+                                  Fan::YSSBG32, Fan::SFK12, Fan::TBD8 });
+const FanSet IMPLY_WZ4 = fanSet({ Fan::QYJ64, Fan::YSSLH64, Fan::QSK24, Fan::QYS24,
+                                  Fan::QDA24, Fan::QZ24, Fan::QX24, Fan::SSSLH16, Fan::QDW16,
+                                  Fan::DYW12, Fan::XYW12, Fan::DY2, Fan::PH2 });
+const FanSet IMPLY_WZ7 = fanSet({ Fan::LQD88, Fan::QYS24, Fan::QDA24, Fan::QZ24, Fan::QX24,
+                                  Fan::DYW12, Fan::XYW12, Fan::DY2 });
+// *INDENT-ON*
+
+// masks over Explain4::Features
+const uint8_t NUM_SUITS = 0b00111;
+const uint8_t Z_SUITS = 0b11000;
+const uint8_t ALL_SUITS = 0b11111;
+const uint64_t F_MASK = uint64_t(0b1111) << 27;
+const uint64_t Y_MASK = uint64_t(0b111) << 31;
+const uint32_t SAME_VAL_MASK = (1 << 0) | (1 << 9) | (1 << 18); // m, p, and s of a value
+const uint32_t QL_MASK = (1 << 0) | (1 << 3) | (1 << 6); // 1, 4, and 7 of a suit
+
+///
+/// \brief Number tiles valued in [lo, hi] as bits by id34
+///
+uint64_t valMask(int lo, int hi)
+{
+    uint64_t suit = ((uint64_t(1) << (hi - lo + 1)) - 1) << (lo - 1);
+    return suit | (suit << 9) | (suit << 18);
+}
+
+uint64_t tileMask(std::initializer_list<T34> ts)
+{
+    uint64_t res = 0;
+    for (T34 t : ts)
+        res |= uint64_t(1) << t.id34();
+
+    return res;
+}
+
+bool in(T34 t, uint64_t mask)
+{
+    return (mask >> t.id34()) & 1;
+}
+
+bool subset(uint64_t bits, uint64_t mask)
+{
+    return (bits & ~mask) == 0;
+}
+
+int popcount(uint64_t x)
+{
+    return __builtin_popcountll(x);
+}
+
+///
+/// \brief Fans of one explanation being built
+///
+/// Mirrors the push-back order of FormGb so that the exclusion
+/// rules see exactly the fans that FormGb would have seen.
+///
+class Acc
+{
+public:
+    Acc()
+    {
+        mCts.fill(0);
+    }
+
+    void add(Fan f)
+    {
+        mCts[f]++;
+        mHas.set(f);
+        mFan += FAN_VALUES[f];
+    }
+
+    bool has(Fan f) const
+    {
+        return mHas.test(f);
+    }
+
+    bool any(const FanSet &fs) const
+    {
+        return (mHas & fs).any();
+    }
+
+    bool empty() const
+    {
+        return mHas.none();
+    }
+
+    int fan() const
+    {
+        return mFan;
+    }
+
+    const FormGbFast::FanCts &cts() const
+    {
+        return mCts;
+    }
+
+private:
+    FormGbFast::FanCts mCts;
+    FanSet mHas;
+    int mFan = 0;
+};
+
+///
+/// \brief Facts shared by all explanations of a hand
+///
+struct Info
+{
+    const Hand &hand;
+    const T37 &pick;
+    const FormCtx &ctx;
+    bool dianpao;
+    bool juezhang;
+    bool menzen;
+    bool singleWait;
+    bool qqr;
+    int sgyCt;
+};
+
+void checkPick(Acc &res, const FormCtx &ctx, bool dianpao)
+{
+    if (ctx.duringKan)
+        res.add(dianpao ? Fan::QGH8 : Fan::GSKH8);
+
+    if (ctx.emptyMount) // not 'else if', addable in GB rule
+        res.add(dianpao ? Fan::HDLY8 : Fan::MSHC8);
+}
+
+template<typename Pred>
+bool any3In(const util::Stactor<T34, 4> &ts, Pred p)
+{
+    if (ts.size() == 3) {
+        return p(ts[0], ts[1], ts[2]);
+    } else if (ts.size() == 4) {
+        return p(ts[0], ts[1], ts[2])
+               || p(ts[0], ts[1], ts[3])
+               || p(ts[0], ts[2], ts[3])
+               || p(ts[1], ts[2], ts[3]);
+    }
+
+    return false;
+}
+
+util::Stactor<T34, 4> sortedByVal(Explain4::Iter b, Explain4::Iter e)
+{
+    util::Stactor<T34, 4> res;
+    for (auto it = b; it != e; ++it)
+        res.pushBack(*it);
+
+    std::sort(res.begin(), res.end(), [](T34 a, T34 b) { return a.val() < b.val(); });
+    return res;
+}
+
+void checkV8864F4(Acc &res, const Explain4 &exp, const Info &info, bool pure)
+{
+    using namespace tiles34;
+    const Explain4::Features &f = exp.features();
+    const std::array<T34, 4> &heads = exp.heads();
+
+    // Dasanyuan Xiaosanyuan
+    int yCt = popcount(f.x34 & Y_MASK);
+    if (yCt == 3)
+        res.add(Fan::DSY88);
+    else if (yCt == 2 && exp.pair().suit() == Suit::Y)
+        res.add(Fan::XSY64);
+
+    // Dasixi Xiaosixi
+    int fCt = popcount(f.x34 & F_MASK);
+    if (fCt == 4)
+        res.add(Fan::DSX88);
+    else if (fCt == 3 && exp.pair().suit() == Suit::F)
+        res.add(Fan::XSX64);
+
+    // Jiulianbaodeng
+    if (info.menzen && pure) {
+        int_fast32_t waitLook = 0;
+        Suit suit = exp.pair().suit();
+        for (int val = 1; val <= 9; val++)
+            waitLook = waitLook * 10 + info.hand.closed().ct(T34(suit, val));
+
+        if (waitLook == 311111113)
+            res.add(Fan::JLBD88);
+    }
+
+    // Sigang
+    if (exp.numO4() + exp.numC4() == 4)
+        res.add(Fan::SG88);
+
+    // Lvyise
+    static const uint64_t GREEN = tileMask({ 2_s, 3_s, 4_s, 6_s, 8_s, 2_y });
+    if (in(exp.pair(), GREEN) && subset(f.seqs, tileMask({ 2_s })) && subset(f.x34, GREEN))
+        res.add(Fan::LYS88);
+
+    // Qingyaojiu
+    if (exp.numX34() == 4 && (f.suits & Z_SUITS) == 0 && f.yaos == Explain4::ALL_YAOS)
+        res.add(Fan::QYJ64);
+
+    // Ziyise
+    if ((f.suits & NUM_SUITS) == 0)
+        res.add(Fan::ZYS64);
+
+    // Si'anke
+    if (exp.numC3() + exp.numC4() == 4)
+        res.add(Fan::SAK64);
+
+    // Yiseshuanglonghui
+    if (pure && exp.numS() == 4 && exp.pair().val() == 5
+        && heads[0].val() == 1 && heads[1].val() == 1
+        && heads[2].val() == 7 && heads[3].val() == 7)
+        res.add(Fan::YSSLH64);
+}
+
+void checkV4832F4(Acc &res, const Explain4 &exp, bool pureNumMelds)
+{
+    const Explain4::Features &f = exp.features();
+    const std::array<T34, 4> &hs = exp.heads();
+
+    // Yisesitongshun
+    if (pureNumMelds && exp.numS() == 4 && hs[0].val() == hs[3].val())
+        res.add(Fan::YSSTS48);
+
+    // Yisesijiegao
+    if (pureNumMelds && exp.numX34() == 4) {
+        uint64_t low = f.x34 >> __builtin_ctzll(f.x34);
+        if ((low & 0b1111) == 0b1111)
+            res.add(Fan::YSSJG48);
+    }
+
+    // Yisesibugao
+    if (pureNumMelds && exp.numS() == 4) {
+        bool twoJump = hs[0].val() == 1 && hs[1].val() == 3
+                       && hs[2].val() == 5 && hs[3].val() == 7;
+        bool oneJump = ((hs[0] | hs[1]) && (hs[1] | hs[2]) && (hs[2] | hs[3]));
+        if (twoJump || oneJump)
+            res.add(Fan::YSSBG32);
+    }
+
+    // Sangang
+    if (exp.numC4() + exp.numO4() == 3)
+        res.add(Fan::SG32);
+
+    // Hunyaojiu
+    if (!res.any(IMPLY_HYJ) && exp.numX34() == 4 && f.yaos == Explain4::ALL_YAOS)
+        res.add(Fan::HYJ32);
+}
+
+void checkV24F4(Acc &res, const Explain4 &exp, bool pure)
+{
+    const Explain4::Features &f = exp.features();
+    const auto &heads = exp.heads();
+
+    // Quanshuangke
+    static const uint64_t DOUBLE = valMask(2, 2) | valMask(4, 4) | valMask(6, 6) | valMask(8, 8);
+    if (exp.numX34() == 4 && in(exp.pair(), DOUBLE) && subset(f.x34, DOUBLE))
+        res.add(Fan::QSK24);
+
+    // Qingyise
+    if (!res.any(IMPLY_QYS) && pure)
+        res.add(Fan::QYS24);
+
+    // Yisesantongshun
+    if (!res.has(Fan::YSSTS48)) {
+        bool a = exp.numS() >= 3 && heads[0] == heads[2];
+        bool b = exp.numS() == 4 && heads[1] == heads[3];
+        if (a || b)
+            res.add(Fan::YSSTS24);
+    }
+
+    // Yisesanjiegao
+    if (!res.has(Fan::YSSJG48) && exp.numX34() == 4) {
+        std::array<T34, 4> xs(heads); // copy
+        std::sort(xs.begin(), xs.end());
+        bool a = (xs[0] | xs [1]) && (xs[1] | xs[2]);
+        bool b = (xs[1] | xs [2]) && (xs[2] | xs[3]);
+        if (a || b)
+            res.add(Fan::YSSJG24);
+    }
+
+    // Quanda Quanzhong Quanxiao
+    static const uint64_t BIG = valMask(7, 9);
+    static const uint64_t MIDDLE = valMask(4, 6);
+    static const uint64_t SMALL = valMask(1, 3);
+    if (in(exp.pair(), BIG) && subset(f.seqs, valMask(7, 7)) && subset(f.x34, BIG))
+        res.add(Fan::QDA24);
+    else if (in(exp.pair(), MIDDLE) && subset(f.seqs, valMask(4, 4)) && subset(f.x34, MIDDLE))
+        res.add(Fan::QZ24);
+    else if (in(exp.pair(), SMALL) && subset(f.seqs, valMask(1, 1)) && subset(f.x34, SMALL))
+        res.add(Fan::QX24);
+}
+
+void checkV16F4(Acc &res, const Explain4 &exp)
+{
+    const Explain4::Features &f = exp.features();
+    const auto &h = exp.heads();
+
+    // Qinglong
+    for (int s = 0; s < 3; s++) {
+        if (((f.seqs >> (9 * s)) & QL_MASK) == QL_MASK) {
+            res.add(Fan::QL16);
+            break;
+        }
+    }
+
+    // Sanseshuanglonghui
+    if (exp.numS() == 4 && exp.pair().val() == 5
+        && h[0].suit() == h[1].suit() && h[2].suit() == h[3].suit()
+        && h[0].suit() != h[2].suit()
+        && exp.pair().suit() != h[0].suit() && exp.pair().suit() != h[2].suit()
+        && h[0].val() == 1 && h[1].val() == 7
+        && h[2].val() == 1 && h[3].val() == 7) {
+        res.add(Fan::SSSLH16);
+    }
+
+    // Yisesanbugao
+    // sequence heads are valued 1~7, so shifts never cross suits
+    uint32_t walk1 = f.seqs & (f.seqs >> 1) & (f.seqs >> 2);
+    uint32_t walk2 = f.seqs & (f.seqs >> 2) & (f.seqs >> 4);
+    if (!res.has(Fan::YSSBG32) && (walk1 != 0 || walk2 != 0))
+        res.add(Fan::YSSBG16);
+
+    // Quandaiwu
+    if (exp.pair().val() == 5 && subset(f.seqs, valMask(3, 5)) && subset(f.x34, valMask(5, 5)))
+        res.add(Fan::QDW16);
+
+    // Santongke
+    for (int v = 0; v < 9; v++) {
+        if (((f.x34 >> v) & SAME_VAL_MASK) == SAME_VAL_MASK) {
+            res.add(Fan::STK16);
+            break;
+        }
+    }
+
+    // San'anke
+    if (exp.numC3() + exp.numC4() == 3)
+        res.add(Fan::SAK16);
+}
+
+void checkV12F4(Acc &res, const Explain4 &exp)
+{
+    const Explain4::Features &f = exp.features();
+
+    // Dayuwu
+    if (!res.has(Fan::QDA24) && in(exp.pair(), valMask(6, 9))
+        && subset(f.seqs, valMask(6, 9)) && subset(f.x34, valMask(6, 9)))
+        res.add(Fan::DYW12);
+
+    // Xiaoyuwu
+    if (!res.has(Fan::QX24) && in(exp.pair(), valMask(1, 4))
+        && subset(f.seqs, valMask(1, 1)) && subset(f.x34, valMask(1, 4)))
+        res.add(Fan::XYW12);
+
+    // Sanfengke
+    if (!res.has(Fan::XSX64) && popcount(f.x34 & F_MASK) == 3)
+        res.add(Fan::SFK12);
+}
+
+void checkV8F4(Acc &res, const Explain4 &exp, const Info &info)
+{
+    using namespace tiles34;
+    const Explain4::Features &f = exp.features();
+
+    // *INDENT-OFF*
+    auto apart = [](T34 a, T34 b, T34 c, int step) {
+        return a.suit() != b.suit() && b.suit() != c.suit() && c.suit() != a.suit()
+                && a.val() + step == b.val() && b.val() + step == c.val();
+    };
+    // *INDENT-ON*
+
+    // Hualong
+    util::Stactor<T34, 4> seqs = sortedByVal(exp.sb(), exp.se());
+    if (any3In(seqs, [&](T34 a, T34 b, T34 c) { return apart(a, b, c, 3); }))
+        res.add(Fan::HL8);
+
+    // Tuibudao
+    static const uint64_t TUMBLER_SEQ = tileMask({ 1_p, 2_p, 3_p, 4_s });
+    static const uint64_t TUMBLER = tileMask({
+        1_p, 2_p, 3_p, 4_p, 5_p, 8_p, 9_p, 2_s, 4_s, 5_s, 6_s, 8_s, 9_s, 1_y
+    });
+    if (in(exp.pair(), TUMBLER) && subset(f.seqs, TUMBLER_SEQ) && subset(f.x34, TUMBLER))
+        res.add(Fan::TBD8);
+
+    // Sansesantongshun
+    for (int v = 0; v < 7; v++) {
+        if (((f.seqs >> v) & SAME_VAL_MASK) == SAME_VAL_MASK) {
+            res.add(Fan::SSSTS8);
+            break;
+        }
+    }
+
+    // Sansesanjiegao
+    util::Stactor<T34, 4> xs = sortedByVal(exp.x34b(), exp.x34e());
+    if (any3In(xs, [&](T34 a, T34 b, T34 c) { return apart(a, b, c, 1); }))
+        res.add(Fan::SSSJG8);
+
+    checkPick(res, info.ctx, info.dianpao);
+}
+
+void checkV6F4(Acc &res, const Explain4 &exp, const Info &info)
+{
+    const Explain4::Features &f = exp.features();
+
+    // Pengpenghu
+    if (!res.any(IMPLY_PPH) && exp.numX34() == 4)
+        res.add(Fan::PPH6);
+
+    // Hunyise
+    if (!res.has(Fan::LYS88) && (f.suits & Z_SUITS) != 0 && popcount(f.suits & NUM_SUITS) == 1)
+        res.add(Fan::HYS6);
+
+    // Sansesanbugao
+    // *INDENT-OFF*
+    auto raise = [](T34 a, T34 b, T34 c) {
+        return a.suit() != b.suit() && b.suit() != c.suit() && c.suit() != a.suit()
+                && a.val() + 1 == b.val() && b.val() + 1 == c.val();
+    };
+    // *INDENT-ON*
+    if (any3In(sortedByVal(exp.sb(), exp.se()), raise))
+        res.add(Fan::SSSBG6);
+
+    // Wumenqi
+    if (f.suits == ALL_SUITS)
+        res.add(Fan::WMQ6);
+
+    // Quanqiuren
+    if (info.qqr)
+        res.add(Fan::QQR6);
+
+    // Shuang'an'gang
+    if (!res.any(IMPLY_SAG) && exp.numC4() == 2)
+        res.add(Fan::SAG6);
+
+    // Shuangjianke
+    if (!res.has(Fan::XSY64) && popcount(f.x34 & Y_MASK) == 2)
+        res.add(Fan::SJK6);
+}
+
+void checkV5F4(Acc &res, const Explain4 &exp)
+{
+    // Ming'an'gang
+    if (!res.any(IMPLY_GANG) && exp.numO4() == 1 && exp.numC4() == 1)
+        res.add(Fan::MAG5);
+}
+
+void checkV4F4(Acc &res, const Explain4 &exp, const Info &info)
+{
+    // Quandaiyao
+    if (!res.any(IMPLY_QDY) && exp.features().yaos == Explain4::ALL_YAOS)
+        res.add(Fan::QDY4);
+
+    // Buqiuren
+    if (!res.any(IMPLY_BQR) && info.menzen && !info.dianpao)
+        res.add(Fan::BQR4);
+
+    // Shuangming'gang
+    if (!res.any(IMPLY_GANG) && exp.numO4() == 2)
+        res.add(Fan::SMG4);
+
+    // Hujuezhang
+    if (info.juezhang)
+        res.add(Fan::HJZ4);
+}
+
+void checkV2F4(Acc &res, const Explain4 &exp, const Info &info)
+{
+    const Explain4::Features &f = exp.features();
+
+    // Jianke
+    if (popcount(f.x34 & Y_MASK) == 1)
+        res.add(Fan::JK2);
+
+    // Quanfengke
+    T34 quanF(Suit::F, info.ctx.roundWind);
+    if (!res.has(Fan::DSX88) && in(quanF, f.x34))
+        res.add(Fan::QFK2);
+
+    // Menfengke
+    T34 menF(Suit::F, info.ctx.selfWind);
+    if (!res.has(Fan::DSX88) && in(menF, f.x34))
+        res.add(Fan::MFK2);
+
+    // Menqianqing
+    if (!res.any(IMPLY_MQQ) && info.menzen)
+        res.add(Fan::MQQ2);
+
+    // Pinghu
+    if (!res.any(IMPLY_PH) && exp.numS() == 4 && exp.pair().isNum())
+        res.add(Fan::PH2);
+
+    // Siguiyi
+    for (int i = 0; i < info.sgyCt; i++)
+        res.add(Fan::SGY2);
+
+    // Shuangtongke
+    if (!res.has(Fan::QYJ64) && !res.has(Fan::STK16))
+        for (auto it = exp.x34b(); it + 1 < exp.x34e(); it++)
+            for (auto jt = it + 1; jt < exp.x34e(); jt++)
+                if (it->isNum() && jt->isNum() && it->val() == jt->val())
+                    res.add(Fan::STK2);
+
+    // Shuanganke
+    if (!res.has(Fan::SAG6) && exp.numC3() + exp.numC4() == 2)
+        res.add(Fan::SAK2);
+
+    // An'gang
+    if (!res.any(IMPLY_GANG) && exp.numC4() == 1)
+        res.add(Fan::AG2);
+
+    // Duanyao
+    if (!res.any(IMPLY_DY) && f.yaos == 0)
+        res.add(Fan::DY2);
+}
+
+void checkV1F4(Acc &res, const Explain4 &exp, const Info &info)
+{
+    const Explain4::Features &f = exp.features();
+    const std::array<T34, 4> &h = exp.heads();
+
+    // Yibangao
+    // Xixiangfeng
+    // Lianliu
+    // Laoshaofu
+    bool ban = !res.any(IMPLY_YBG);
+    bool feng = !res.any(IMPLY_XXF);
+    bool lian = !res.any(IMPLY_LL);
+    bool lao = !res.any(IMPLY_LSF);
+    if (exp.numS() >= 2) {
+        // wasting triangle of spaces, that's ok
+        std::array<std::array<bool, 4>, 4> edges {};
+
+        for (int i = 0; i + 1 < exp.numS(); i++) {
+            for (int j = i + 1; j < exp.numS(); j++) {
+                // prevent loop
+                if (i == 1) {
+                    if (edges[0][i] && edges[0][j])
+                        continue;
+                } else if (i == 2) {
+                    if (edges[0][i] && edges[0][j])
+                        continue;
+
+                    if (edges[0][1] && edges[1][i] && edges[0][j])
+                        continue;
+
+                    if (edges[1][i] && edges[1][j])
+                        continue;
+                }
+
+                T34 a = h[i];
+                T34 b = h[j];
+                if (ban && a == b) {
+                    res.add(Fan::YBG1);
+                    edges[i][j] = true;
+                } else if (feng && a.suit() != b.suit() && a.val() == b.val()) {
+                    res.add(Fan::XXF1);
+                    edges[i][j] = true;
+                } else if (lian && (a ^ b)) {
+                    res.add(Fan::LL1);
+                    edges[i][j] = true;
+                } else if (lao && a.suit() == b.suit() && a.val() == 1 && b.val() == 7) {
+                    res.add(Fan::LSF1);
+                    edges[i][j] = true;
+                }
+            }
+        }
+    }
+
+    // Yaojiuke
+    if (!res.any(IMPLY_YJK)) {
+        for (auto it = exp.x34b(); it != exp.x34e(); it++) {
+            bool num19 = it->isNum19();
+            bool okF = it->suit() == Suit::F
+                && !res.has(Fan::XSX64)
+                && it->val() != info.ctx.selfWind
+                && it->val() != info.ctx.roundWind;
+            if (num19 || okF)
+                res.add(Fan::YJK1);
+        }
+    }
+
+    // Ming'gang
+    if (!res.any(IMPLY_GANG) && exp.numO4() == 1)
+        res.add(Fan::MG1);
+
+    // Queyimen
+    if (!res.any(IMPLY_QYM) && popcount(f.suits & NUM_SUITS) == 2)
+        res.add(Fan::QYM1);
+
+    // Wuzi
+    if (!res.any(IMPLY_WZ4) && (f.suits & Z_SUITS) == 0)
+        res.add(Fan::WZ1);
+
+    // Bianzhang
+    // Kanzhang
+    // Dandiaojiang
+    if (info.singleWait) {
+        switch (exp.wait()) {
+        case Wait::SIDE:
+            res.add(Fan::BZ1);
+            break;
+        case Wait::CLAMP:
+            res.add(Fan::KZ1);
+            break;
+        case Wait::ISORIDE:
+            if (!res.has(Fan::SG88) && !res.has(Fan::QQR6))
+                res.add(Fan::DDJ1);
+
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Zimo
+    if (!res.has(Fan::BQR4) && !info.dianpao)
+        res.add(Fan::ZM1);
+}
+
+Acc calcF4(const Explain4 &exp, const Info &info)
+{
+    Acc res;
+
+    const std::array<T34, 4> &heads = exp.heads();
+    uint8_t suits = exp.features().suits;
+    bool pureNumMelds = heads[0].isNum()
+        && heads[0].suit() == heads[1].suit()
+        && heads[1].suit() == heads[2].suit()
+        && heads[2].suit() == heads[3].suit();
+    bool pure = pureNumMelds && popcount(suits) == 1;
+
+    checkV8864F4(res, exp, info, pure);
+    checkV4832F4(res, exp, pureNumMelds);
+    checkV24F4(res, exp, pure);
+    checkV16F4(res, exp);
+    checkV12F4(res, exp);
+    checkV8F4(res, exp, info);
+    checkV6F4(res, exp, info);
+    checkV5F4(res, exp);
+    checkV4F4(res, exp, info);
+    checkV2F4(res, exp, info);
+    checkV1F4(res, exp, info);
+    if (res.empty()) // Wufanhu
+        res.add(Fan::WFH8);
+
+    return res;
+}
+
+Acc calcF7(const Info &info)
+{
+    Acc res;
+
+    // Lianqidui
+    const auto &ts = info.hand.closed().t34s13();
+    bool lqd = ts[0].suit() == ts.back().suit() && ts[0].val() + 6 == ts.back().val();
+    if (lqd)
+        res.add(Fan::LQD88);
+
+    // Qidui
+    if (!lqd)
+        res.add(Fan::Q7D24);
+
+    // Qingyise
+    if (!lqd && ts.front().suit() == ts.back().suit())
+        res.add(Fan::QYS24);
+
+    uint64_t bits = 0;
+    uint8_t suits = 0;
+    for (T34 t : ts) {
+        bits |= uint64_t(1) << t.id34();
+        suits |= 1 << static_cast<int>(t.suit());
+    }
+
+    // Quanda Quanzhong Quanxiao
+    if (subset(bits, valMask(7, 9)))
+        res.add(Fan::QDA24);
+
+    if (subset(bits, valMask(4, 6)))
+        res.add(Fan::QZ24);
+
+    if (subset(bits, valMask(1, 3)))
+        res.add(Fan::QX24);
+
+    // Dayuwu Xiaoyuwu
+    if (!res.has(Fan::QDA24) && subset(bits, valMask(5, 9)))
+        res.add(Fan::DYW12);
+
+    if (!res.has(Fan::QX24) && subset(bits, valMask(1, 5)))
+        res.add(Fan::XYW12);
+
+    // Tuibudao
+    using namespace tiles34;
+    static const uint64_t TUMBLER = tileMask({
+        1_p, 2_p, 3_p, 4_p, 5_p, 8_p, 9_p, 2_s, 4_s, 5_s, 6_s, 8_s, 9_s, 1_y
+    });
+    if (subset(bits, TUMBLER))
+        res.add(Fan::TBD8);
+
+    checkPick(res, info.ctx, info.dianpao);
+
+    int numSuitCt = popcount(suits & NUM_SUITS);
+
+    // Hunyise
+    if ((suits & Z_SUITS) != 0 && numSuitCt == 1)
+        res.add(Fan::HYS6);
+
+    // Wumenqi
+    if (suits == ALL_SUITS)
+        res.add(Fan::WMQ6);
+
+    // Duanyao
+    static const uint64_t YAO = tileMask({
+        1_m, 9_m, 1_p, 9_p, 1_s, 9_s, 1_f, 2_f, 3_f, 4_f, 1_y, 2_y, 3_y
+    });
+    if (!res.has(Fan::QZ24) && (bits & YAO) == 0)
+        res.add(Fan::DY2);
+
+    // Siguiyi
+    if (!res.has(Fan::YSSTS48))
+        for (T34 t : tiles34::ALL34)
+            if (info.hand.closed().ct(t) >= 3) // 4 or 3+pick
+                res.add(Fan::SGY2);
+
+    // Queyimen
+    if (!res.has(Fan::TBD8) && numSuitCt == 2)
+        res.add(Fan::QYM1);
+
+    // Wuzi
+    if (!res.any(IMPLY_WZ7) && (suits & Z_SUITS) == 0)
+        res.add(Fan::WZ1);
+
+    // Zimo
+    if (!info.dianpao)
+        res.add(Fan::ZM1);
+
+    return res;
+}
+
+
+
+} // namespace
+
+
+
+FormGbFast::FormGbFast(const Hand &ready, const T37 &pick, const FormCtx &ctx, bool juezhang)
+{
+    mCts.fill(0);
+
+    if (ready.peekPickStep13(pick) == -1) {
+        Acc acc;
+        acc.add(Fan::SSY88);
+        checkPick(acc, ctx, true);
+        mCts = acc.cts();
+    } else {
+        init(ready, pick, ctx, juezhang,
+             ready.peekPickStep4(pick) == -1, ready.peekPickStep7Gb(pick) == -1);
+    }
+
+    mFan = 0;
+    for (int f = 0; f < Fan::NUM_FANS; f++)
+        mFan += mCts[f] * FAN_VALUES[f];
+}
+
+FormGbFast::FormGbFast(const Hand &full, const FormCtx &ctx, bool juezhang)
+{
+    assert(full.hasDrawn());
+
+    mCts.fill(0);
+
+    if (full.step13() == -1) {
+        Acc acc;
+        acc.add(Fan::SSY88);
+        checkPick(acc, ctx, false);
+        acc.add(Fan::ZM1);
+        mCts = acc.cts();
+    } else {
+        init(full, full.drawn(), ctx, juezhang, full.step4() == -1, full.step7Gb() == -1);
+    }
+
+    mFan = 0;
+    for (int f = 0; f < Fan::NUM_FANS; f++)
+        mFan += mCts[f] * FAN_VALUES[f];
+}
+
+int FormGbFast::fanOf(Fan f)
+{
+    return FAN_VALUES[f];
+}
+
+int FormGbFast::fan() const
+{
+    return mFan;
+}
+
+int FormGbFast::ct(Fan f) const
+{
+    return mCts[f];
+}
+
+///
+/// \brief Fans sorted by the enum order, repeated ones repeated
+///
+FormGb::Fans FormGbFast::fans() const
+{
+    FormGb::Fans res;
+    for (int f = 0; f < Fan::NUM_FANS; f++)
+        res.insert(res.end(), mCts[f], Fan(f));
+
+    return res;
+}
+
+///
+/// \param hand The ready hand with 'pick' as a ron, or the full hand with 'pick' drawn
+///
+void FormGbFast::init(const Hand &hand, const T37 &pick, const FormCtx &ctx, bool juezhang,
+                      bool f4, bool f7)
+{
+    bool dianpao = !hand.hasDrawn();
+
+    // hand-level facts, same for every explanation
+    bool qqr = hand.barks().size() == 4
+        && util::none(hand.barks(), [](const M37 &m) { return m.type() == M37::Type::ANKAN; });
+
+    int sgyCt = 0;
+    if (f4) {
+        TileCount noGang(hand.closed()); // copy
+        for (const M37 &m : hand.barks())
+            if (!m.isKan())
+                for (const T37 &t : m.tiles())
+                    noGang.inc(t, 1);
+
+        noGang.inc(pick, 1);
+        for (T34 t : tiles34::ALL34)
+            sgyCt += noGang.ct(t) == 4;
+    }
+
+    Info info { hand, pick, ctx, dianpao, juezhang, hand.isMenzen(),
+                dianpao && hand.effASet().count() == 1, qqr, sgyCt };
+
+    int best = 0;
+
+    if (f4) {
+        Explain4::Explain4s exps = Explain4::make(hand.closed(), hand.barks(), pick, dianpao);
+
+        // *INDENT-OFF*
+        auto same = [](const Explain4 &a, const Explain4 &b) {
+            return a.heads() == b.heads() && a.wait() == b.wait() && a.pair() == b.pair()
+                    && a.numO3() == b.numO3() && a.numC3() == b.numC3()
+                    && a.numO4() == b.numO4() && a.numC4() == b.numC4();
+        };
+        // *INDENT-ON*
+
+        for (auto it = exps.begin(); it != exps.end(); ++it) {
+            if (std::any_of(exps.begin(), it, [&](const Explain4 &e) { return same(e, *it); }))
+                continue; // cannot be strictly better than its twin
+
+            Acc acc = calcF4(*it, info);
+            if (acc.fan() > best) {
+                best = acc.fan();
+                mCts = acc.cts();
+            }
+        }
+    }
+
+    if (f7) {
+        Acc acc = calcF7(info);
+        if (acc.fan() > best) {
+            best = acc.fan();
+            mCts = acc.cts();
+        }
+    }
+
+    assert(best > 0);
+}
+
+
+
+} // namespace saki
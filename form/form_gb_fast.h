@@ -0,0 +1,58 @@
+#ifndef SAKI_FORM_GB_FAST_H
+#define SAKI_FORM_GB_FAST_H
+
+#include "form_gb.h"
+
+
+
+namespace saki
+{
+
+
+
+///
+/// \brief Allocation-free GB fan evaluator for bulk scoring
+///
+/// Gives the same fan() and the same multiset of fans() as FormGb,
+/// which stays as the reference implementation.
+/// Hand-level facts (waiting tile count, siguiyi, quanqiuren, ...)
+/// are computed once per hand instead of once per explanation,
+/// identical explanations are evaluated only once, and the fan
+/// exclusion rules are tested as bit masks over Explain4::Features.
+///
+/// Explanations are not pruned by an upper bound of their fans. Most
+/// later explanations of a hand tie with the best one, which only a
+/// bound as exact as the evaluation itself could rule out, so a bound
+/// costs more than the explanations it skips.
+///
+class FormGbFast
+{
+public:
+    using FanCts = std::array<uint8_t, Fan::NUM_FANS>;
+
+    FormGbFast(const Hand &ready, const T37 &pick, const FormCtx &ctx, bool juezhang);
+    FormGbFast(const Hand &full, const FormCtx &ctx, bool juezhang);
+    ~FormGbFast() = default;
+
+    static int fanOf(Fan f);
+
+    int fan() const;
+    int ct(Fan f) const;
+    FormGb::Fans fans() const;
+
+private:
+    void init(const Hand &hand, const T37 &pick, const FormCtx &ctx, bool juezhang,
+              bool f4, bool f7);
+
+private:
+    FanCts mCts;
+    int mFan = 0;
+};
+
+
+
+} // namespace saki
+
+
+
+#endif // SAKI_FORM_GB_FAST_H
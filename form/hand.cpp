@@ -1,5 +1,7 @@
 #include "hand.h"
-#include "../form/form.h"
+#include "packed_tile_count.h"
+#include "lazy_form.h"
+#include "wait_table.h"
 #include "../util/assume.h"
 #include "../util/misc.h"
 
@@ -294,7 +296,7 @@ bool Hand::canRon(T34 t, const FormCtx &ctx, const Rule &rule, bool &doujun) con
         return false;
 
     T37 pick(t.id34()); // whether aka5 does not affect ronnablity
-    bool yaku = Form(*this, pick, ctx, rule).hasYaku();
+    bool yaku = LazyForm(*this, pick, ctx, rule).hasYaku();
     doujun = !yaku;
     return yaku;
 }
@@ -302,7 +304,7 @@ bool Hand::canRon(T34 t, const FormCtx &ctx, const Rule &rule, bool &doujun) con
 bool Hand::canTsumo(const FormCtx &ctx, const Rule &rule) const
 {
     assert(mHasDrawn);
-    return step() == -1 && Form(*this, ctx, rule).hasYaku();
+    return step() == -1 && LazyForm(*this, ctx, rule).hasYaku();
 }
 
 bool Hand::canRiichi(util::Stactor<T37, 13> &swappables, bool &spinnable) const
@@ -336,10 +338,7 @@ bool Hand::ready() const
 
 int Hand::step() const
 {
-    if (usingCache())
-        return loadCache().step();
-
-    return peekStay(&TileCount::step, mBarks.size());
+    return std::min({ step4(), step7(), step13() });
 }
 
 int Hand::stepGb() const
@@ -349,17 +348,15 @@ int Hand::stepGb() const
 
 int Hand::step4() const
 {
-    if (usingCache())
-        return loadCache().step4();
+    int res;
+    if (mSteps.step4(*this, res))
+        return res;
 
     return peekStay(&TileCount::step4, mBarks.size());
 }
 
 int Hand::step7() const
 {
-    if (usingCache())
-        return loadCache().step7();
-
     return mBarks.empty() ? peekStay(&TileCount::step7) : Parseds::STEP_INF;
 }
 
@@ -370,58 +367,76 @@ int Hand::step7Gb() const
 
 int Hand::step13() const
 {
-    if (usingCache())
-        return loadCache().step13();
-
     return mBarks.empty() ? peekStay(&TileCount::step13) : Parseds::STEP_INF;
 }
 
 bool Hand::hasEffA(T34 t) const
 {
-    if (usingCache())
-        return loadCache().effASet()[t.id34()];
-
-    return peekStay(&TileCount::hasEffA, mBarks.size(), t);
+    return effASet()[t.id34()];
 }
 
 bool Hand::hasEffA4(T34 t) const
 {
-    if (usingCache())
-        return loadCache().effA4Set()[t.id34()];
-
-    return peekStay(&TileCount::hasEffA4, mBarks.size(), t);
+    return effA4Set()[t.id34()];
 }
 
 bool Hand::hasEffA7(T34 t) const
 {
-    if (usingCache())
-        return loadCache().effA7Set()[t.id34()];
-
     return mBarks.empty() && peekStay(&TileCount::hasEffA7, t);
 }
 
 bool Hand::hasEffA13(T34 t) const
 {
-    if (usingCache())
-        return loadCache().effA13Set()[t.id34()];
-
     return mBarks.empty() && peekStay(&TileCount::hasEffA13, t);
 }
 
 util::Stactor<T34, 34> Hand::effA() const
 {
-    if (usingCache())
-        return loadCache().effA();
-
-    return parse().effA();
+    return tiles34::toStactor(effASet());
 }
 
 util::Stactor<T34, 34> Hand::effA4() const
 {
-    if (usingCache())
-        return loadCache().effA4();
+    return tiles34::toStactor(effA4Set());
+}
 
-    return parse().effA4();
+///
+/// \brief Same as parse().effASet() without parsing the 4-meld forms
+///
+std::bitset<34> Hand::effASet() const
+{
+    if (usingCache() && mParseCache.has_value())
+        return mParseCache->effASet();
+
+    if (!mBarks.empty())
+        return effA4Set();
+
+    int s4 = step4();
+    int s7 = step7();
+    int s13 = step13();
+    int minStep = std::min({ s4, s7, s13 });
+
+    std::bitset<34> res;
+
+    if (s4 == minStep)
+        res |= effA4Set();
+
+    if (s7 == minStep)
+        res |= peekStay(&TileCount::parse7).effA7Set();
+
+    if (s13 == minStep)
+        res |= peekStay(&TileCount::parse13).effA13Set();
+
+    return res;
+}
+
+std::bitset<34> Hand::effA4Set() const
+{
+    std::bitset<34> res;
+    if (mSteps.effA4Set(*this, res))
+        return res;
+
+    return parse4().effA4Set();
 }
 
 Parseds Hand::parse() const
@@ -450,16 +465,138 @@ int Hand::estimate(const Rule &rule, int sw, int rw, const util::Stactor<T37, 5>
     ctx.selfWind = sw;
     ctx.roundWind = rw;
 
-    int max = 0;
+    // only ron forms are needed, and mostly only their hasYaku()
+    return WaitTable(*this, ctx, rule, drids).maxRonGain();
+}
+
+///
+/// \brief Evaluate discarding every distinct kind in closed + drawn
+/// \param remain Remaining tiles used to count 'remainEffA'
+/// \param below Omit kinds whose resulting step is not below it
+/// \return Same as peekDiscard() on step() and effASet() of each kind
+///
+/// Much cheaper than peeking one by one since the step lookups of the
+/// suits not containing the discarded tile are shared by all candidates.
+///
+util::Stactor<Hand::DiscardEval, 14> Hand::evaluateDiscards(const TileCount &remain, int below) const
+{
+    assert(mHasDrawn);
 
-    for (T34 t : effA()) {
-        T37 pick(t.id34());
-        Form form(*this, pick, ctx, rule, drids);
-        if (form.hasYaku())
-            max = std::max(max, form.gain());
+    const int barkCt = mBarks.size();
+    const PackedTileCount packedRemain(remain);
+    TileCount full(mClosed);
+    full.inc(mDrawn, 1);
+
+    util::Stactor<DiscardEval, 14> res;
+
+    for (T34 out : tiles34::ALL34) {
+        if (full.ct(out) == 0)
+            continue;
+
+        T37 t37(out.id34());
+        if (t37.val() == 5 && full.ct(t37) == 0)
+            t37 = t37.toAka5();
+
+        full.inc(t37, -1);
+
+        DiscardEval eval;
+        eval.out = out;
+
+        int step4;
+        if (!mSteps.discardStep4(*this, out, step4))
+            step4 = full.step4(barkCt);
+
+        int step7 = barkCt == 0 ? full.step7() : Parseds::STEP_INF;
+        int step13 = barkCt == 0 ? full.step13() : Parseds::STEP_INF;
+        eval.step = std::min({ step4, step7, step13 });
+
+        if (eval.step >= below) {
+            full.inc(t37, 1);
+            continue;
+        }
+
+        if (step4 == eval.step) {
+            std::bitset<34> effA4;
+            if (mSteps.discard4(*this, out, step4, effA4))
+                eval.effA |= effA4;
+            else
+                eval.effA |= full.parse4(barkCt).effA4Set();
+        }
+
+        if (step7 == eval.step)
+            eval.effA |= full.parse7().effA7Set();
+
+        if (step13 == eval.step)
+            eval.effA |= full.parse13().effA13Set();
+
+        eval.remainEffA = packedRemain.ct(eval.effA);
+
+        full.inc(t37, 1);
+        res.pushBack(eval);
     }
 
-    return max;
+    return res;
+}
+
+///
+/// \brief Fill 'remainEffB' of the results of evaluateDiscards()
+/// \param evals Results of evaluateDiscards() on this hand
+/// \param remain The same remaining tiles given to evaluateDiscards()
+///
+/// For each discard, sum up the best 'remainEffA' reachable after each
+/// of its effective draws followed by one more step-keeping discard,
+/// weighted by the remaining count of that draw. The drawn tile itself
+/// is taken out of the remaining tiles at the second level.
+/// Discards already ready (step <= 0) are left zero.
+///
+/// Every second-level hand is a copy sharing the step lookups of the
+/// first-level one, so only the suit of the draw is looked up again.
+/// Callers may drop uninteresting discards from 'evals' beforehand,
+/// typically keeping only the ones of the minimum step.
+///
+void Hand::evaluateEffB(util::Stactor<DiscardEval, 14> &evals, const TileCount &remain) const
+{
+    assert(mHasDrawn);
+
+    TileCount rest(remain);
+
+    for (DiscardEval &eval : evals) {
+        eval.remainEffB = 0;
+        if (eval.step <= 0)
+            continue;
+
+        Hand after(*this);
+        if (mDrawn == eval.out) {
+            after.spinOut();
+        } else {
+            T37 out(eval.out.id34());
+            if (out.val() == 5 && mClosed.ct(out) == 0)
+                out = out.toAka5();
+
+            after.swapOut(out);
+        }
+
+        for (T34 t : tiles34::ALL34) {
+            int weight = remain.ct(t);
+            if (!eval.effA[t.id34()] || weight == 0)
+                continue;
+
+            T37 in(t.id34());
+            if (in.val() == 5 && rest.ct(in) == 0)
+                in = in.toAka5();
+
+            Hand next(after);
+            next.draw(in);
+            rest.inc(in, -1);
+
+            int best = 0;
+            for (const DiscardEval &second : next.evaluateDiscards(rest, eval.step))
+                best = std::max(best, second.remainEffA);
+
+            rest.inc(in, 1);
+            eval.remainEffB += weight * best;
+        }
+    }
 }
 
 int Hand::peekPickStep(T34 pick) const
@@ -496,6 +633,7 @@ void Hand::draw(const T37 &in)
 
     mDrawn = in;
     mHasDrawn = true;
+    mSteps.touch(in);
 }
 
 void Hand::swapOut(const T37 &out)
@@ -509,6 +647,7 @@ void Hand::swapOut(const T37 &out)
     mClosed.inc(out, -1);
     mClosed.inc(mDrawn, 1);
     mHasDrawn = false;
+    mSteps.touch(out); // the drawn one just moved into the closed part
 }
 
 void Hand::spinOut()
@@ -519,6 +658,7 @@ void Hand::spinOut()
         mParseCache.reset();
 
     mHasDrawn = false;
+    mSteps.touch(mDrawn);
 }
 
 void Hand::barkOut(const T37 &out)
@@ -530,6 +670,7 @@ void Hand::barkOut(const T37 &out)
         mParseCache.reset();
 
     mClosed.inc(out, -1);
+    mSteps.touch(out);
 }
 
 void Hand::chiiAsLeft(const T37 &pick, bool showAka5)
@@ -648,6 +789,7 @@ void Hand::kakan(int barkId)
     }
 
     mHasDrawn = false;
+    mSteps.touch(t);
 
     mBarks[barkId].kakan(t);
 }
@@ -706,6 +848,7 @@ T37 Hand::tryShow(T34 t34, bool showAka5)
 
     assert(mClosed.ct(t37) > 0);
     mClosed.inc(t37, -1);
+    mSteps.touch(t37);
 
     return t37;
 }
@@ -734,6 +877,7 @@ Hand::DeltaSpin::~DeltaSpin()
 {
     mHand.mSkipCacheLevel--;
     mHand.mHasDrawn = true;
+    mHand.mSteps.touch(mHand.mDrawn);
 }
 
 
@@ -752,6 +896,7 @@ Hand::DeltaSwap::~DeltaSwap()
     mHand.mHasDrawn = true;
     mHand.mClosed.inc(mHand.mDrawn, -1);
     mHand.mClosed.inc(mOut, 1);
+    mHand.mSteps.touch(mOut);
 }
 
 Hand::DeltaCp::DeltaCp(Hand &hand, const T37 &pick, const Action &a, const T37 &out)
@@ -785,11 +930,15 @@ Hand::DeltaCp::~DeltaCp()
     mHand.mSkipCacheLevel--;
 
     mHand.mClosed.inc(mOut, 1);
+    mHand.mSteps.touch(mOut);
 
     const M37 &cp = mHand.mBarks.back();
-    for (int i = 0; static_cast<size_t>(i) < cp.tiles().size(); i++)
-        if (i != cp.layIndex())
+    for (int i = 0; static_cast<size_t>(i) < cp.tiles().size(); i++) {
+        if (i != cp.layIndex()) {
             mHand.mClosed.inc(cp[i], 1);
+            mHand.mSteps.touch(cp[i]);
+        }
+    }
 
     mHand.mBarks.popBack();
 }
@@ -4,6 +4,7 @@
 #include "rule.h"
 #include "form_ctx.h"
 #include "tile_count.h"
+#include "step_cache.h"
 #include "../unit/action.h"
 #include "../unit/meld.h"
 
@@ -17,6 +18,18 @@ namespace saki
 class Hand
 {
 public:
+    ///
+    /// \brief Outcome of discarding one kind of tile from a drawn hand
+    ///
+    struct DiscardEval
+    {
+        T34 out;
+        int step;
+        std::bitset<34> effA;
+        int remainEffA; ///< Sum of 'effA' in the given remaining tiles
+        int remainEffB = 0; ///< Filled by evaluateEffB() only
+    };
+
     Hand() = default;
     explicit Hand(const TileCount &count);
     explicit Hand(const TileCount &count, const util::Stactor<M37, 4> &barks);
@@ -69,12 +82,18 @@ public:
 
     util::Stactor<T34, 34> effA() const;
     util::Stactor<T34, 34> effA4() const;
+    std::bitset<34> effASet() const;
+    std::bitset<34> effA4Set() const;
 
     Parseds parse() const;
     Parsed4s parse4() const;
 
     int estimate(const Rule &rule, int sw, int rw, const util::Stactor<T37, 5> &drids) const;
 
+    util::Stactor<DiscardEval, 14> evaluateDiscards(const TileCount &remain,
+                                                     int below = Parseds::STEP_INF) const;
+    void evaluateEffB(util::Stactor<DiscardEval, 14> &evals, const TileCount &remain) const;
+
     int peekPickStep(T34 pick) const;
     int peekPickStep4(T34 pick) const;
     int peekPickStep7(T34 pick) const;
@@ -198,6 +217,7 @@ private:
     util::Stactor<M37, 4> mBarks;
     mutable std::optional<Parseds> mParseCache;
     mutable int mSkipCacheLevel = 0; ///< Ignore cache iff > 0
+    mutable StepCache mSteps; ///< Touched by every tile delta, peeks included
 };
 
 int operator%(T34 ind, const Hand &hand);
@@ -0,0 +1,90 @@
+#include "lazy_form.h"
+
+
+
+namespace saki
+{
+
+
+
+LazyForm::LazyForm(const Hand &ready, const T37 &pick, const FormCtx &ctx, const Rule &rule,
+                   const util::Stactor<T37, 5> &drids, const util::Stactor<T37, 5> &urids)
+    : mHand(ready)
+    , mPick(pick)
+    , mRon(true)
+    , mCtx(ctx)
+    , mRule(rule)
+    , mDrids(drids)
+    , mUrids(urids)
+{
+}
+
+LazyForm::LazyForm(const Hand &full, const FormCtx &ctx, const Rule &rule,
+                   const util::Stactor<T37, 5> &drids, const util::Stactor<T37, 5> &urids)
+    : mHand(full)
+    , mPick(full.drawn())
+    , mRon(false)
+    , mCtx(ctx)
+    , mRule(rule)
+    , mDrids(drids)
+    , mUrids(urids)
+{
+}
+
+///
+/// \brief Same as form().hasYaku()
+///
+bool LazyForm::hasYaku() const
+{
+    if (!mHasYaku.has_value())
+        mHasYaku = mForm.has_value() ? mForm->hasYaku() : guessYaku();
+
+    return *mHasYaku;
+}
+
+///
+/// \brief Same as form().gain()
+///
+int LazyForm::gain() const
+{
+    return form().gain();
+}
+
+const Form &LazyForm::form() const
+{
+    if (!mForm.has_value()) {
+        if (mRon)
+            mForm.emplace(mHand, mPick, mCtx, mRule, mDrids, mUrids);
+        else
+            mForm.emplace(mHand, mCtx, mRule, mDrids, mUrids);
+    }
+
+    return *mForm;
+}
+
+///
+/// \brief Decide hasYaku() in the same order of winning types as Form
+///
+bool LazyForm::guessYaku() const
+{
+    int step13 = mRon ? mHand.peekPickStep13(mPick) : mHand.step13();
+    if (step13 == -1)
+        return true; // kokushi is yakuman
+
+    int step4 = mRon ? mHand.peekPickStep4(mPick) : mHand.step4();
+    if (step4 != -1)
+        return true; // chiitoitsu is a yaku
+
+    switch (Form(mRon, mCtx).guessYaku4(mCtx, mRule, mHand, mPick)) {
+    case Form::YakuGuess::NO:
+        return false;
+    case Form::YakuGuess::YES:
+        return true;
+    default:
+        return form().hasYaku();
+    }
+}
+
+
+
+} // namespace saki
@@ -0,0 +1,64 @@
+#ifndef SAKI_LAZY_FORM_H
+#define SAKI_LAZY_FORM_H
+
+#include "form.h"
+
+#include <optional>
+
+
+
+namespace saki
+{
+
+
+
+///
+/// \brief Form computing only what is queried, memoised
+///
+/// Most hypothetical wins only need hasYaku(), which is usually
+/// decided by the context yakus or by checking the yakus of each
+/// explanation, skipping fu, han, and dora. The full Form is built
+/// at the first query needing it, and shared by later queries.
+///
+/// Holds the hand and the rule by reference, both must outlive it.
+///
+class LazyForm
+{
+public:
+    LazyForm(const Hand &ready, const T37 &pick, const FormCtx &ctx, const Rule &rule,
+             const util::Stactor<T37, 5> &drids = util::Stactor<T37, 5>(),
+             const util::Stactor<T37, 5> &urids = util::Stactor<T37, 5>());
+    LazyForm(const Hand &full, const FormCtx &ctx, const Rule &rule,
+             const util::Stactor<T37, 5> &drids = util::Stactor<T37, 5>(),
+             const util::Stactor<T37, 5> &urids = util::Stactor<T37, 5>());
+
+    LazyForm(const LazyForm &copy) = delete;
+    LazyForm &operator=(const LazyForm &assign) = delete;
+    ~LazyForm() = default;
+
+    bool hasYaku() const;
+    int gain() const;
+    const Form &form() const;
+
+private:
+    bool guessYaku() const;
+
+private:
+    const Hand &mHand;
+    const T37 mPick;
+    const bool mRon;
+    const FormCtx mCtx;
+    const Rule &mRule;
+    const util::Stactor<T37, 5> mDrids;
+    const util::Stactor<T37, 5> mUrids;
+    mutable std::optional<bool> mHasYaku;
+    mutable std::optional<Form> mForm;
+};
+
+
+
+} // namespace saki
+
+
+
+#endif // SAKI_LAZY_FORM_H
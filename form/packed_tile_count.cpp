@@ -0,0 +1,215 @@
+#include "packed_tile_count.h"
+
+#include <cassert>
+
+
+
+namespace saki
+{
+
+
+
+namespace
+{
+
+const int AKA5_LANE = 34;
+const uint64_t ALL_LANES = (uint64_t(1) << 37) - 1;
+const uint64_t Z_LANES = ((uint64_t(1) << 34) - 1) & ~((uint64_t(1) << 27) - 1);
+const uint64_t NUM19_LANES = (uint64_t(1) << 0) | (uint64_t(1) << 8)
+    | (uint64_t(1) << 9) | (uint64_t(1) << 17)
+    | (uint64_t(1) << 18) | (uint64_t(1) << 26);
+
+uint64_t numSuitLanes(Suit s)
+{
+    assert(s == Suit::M || s == Suit::P || s == Suit::S);
+    int begin = 9 * static_cast<int>(s);
+    return (((uint64_t(1) << 9) - 1) << begin) | (uint64_t(1) << (AKA5_LANE + static_cast<int>(s)));
+}
+
+int popcount(uint64_t x)
+{
+    return __builtin_popcountll(x);
+}
+
+} // namespace
+
+
+
+PackedTileCount::PackedTileCount()
+{
+    mPlanes.fill(0);
+}
+
+PackedTileCount::PackedTileCount(const TileCount &count)
+{
+    mPlanes.fill(0);
+
+    for (const T37 &t : tiles37::ORDER37)
+        setLane(laneOf(t), count.ct(t));
+}
+
+TileCount PackedTileCount::unpack() const
+{
+    TileCount res;
+
+    for (const T37 &t : tiles37::ORDER37)
+        res.inc(t, lane(laneOf(t)));
+
+    return res;
+}
+
+int PackedTileCount::ct(T34 t) const
+{
+    int res = lane(t.id34());
+    if (t.isNum() && t.val() == 5)
+        res += lane(AKA5_LANE + static_cast<int>(t.suit()));
+
+    return res;
+}
+
+int PackedTileCount::ct(const T37 &t) const
+{
+    return lane(laneOf(t));
+}
+
+int PackedTileCount::ct(Suit s) const
+{
+    if (s == Suit::F || s == Suit::Y) {
+        T34 head(s, 1);
+        uint64_t mask = ((uint64_t(1) << head.period()) - 1) << head.id34();
+        return weigh(mask);
+    }
+
+    return weigh(numSuitLanes(s));
+}
+
+///
+/// \brief Sum of the counts of the kinds in 'ts', red fives included
+///
+int PackedTileCount::ct(const std::bitset<34> &ts) const
+{
+    return weigh(withAka5(ts.to_ullong()));
+}
+
+int PackedTileCount::ctAka5() const
+{
+    return weigh(ALL_LANES & ~((uint64_t(1) << AKA5_LANE) - 1));
+}
+
+int PackedTileCount::ctZ() const
+{
+    return weigh(Z_LANES);
+}
+
+int PackedTileCount::ctYao() const
+{
+    return weigh(NUM19_LANES | Z_LANES);
+}
+
+int PackedTileCount::sum() const
+{
+    return weigh(ALL_LANES);
+}
+
+///
+/// \return true if 'that' is a subset of 'this'
+///
+bool PackedTileCount::covers(const PackedTileCount &that) const
+{
+    std::array<uint64_t, 3> diff;
+    return borrowOf(that, diff) == 0;
+}
+
+void PackedTileCount::inc(const T37 &t, int delta)
+{
+    int i = laneOf(t);
+    assert(lane(i) + delta >= 0);
+    setLane(i, lane(i) + delta);
+}
+
+PackedTileCount &PackedTileCount::operator-=(const PackedTileCount &rhs)
+{
+    uint64_t borrow = borrowOf(rhs, mPlanes);
+    assert(borrow == 0);
+    (void) borrow;
+    return *this;
+}
+
+bool PackedTileCount::operator==(const PackedTileCount &that) const
+{
+    return mPlanes == that.mPlanes;
+}
+
+bool PackedTileCount::operator!=(const PackedTileCount &that) const
+{
+    return !(*this == that);
+}
+
+int PackedTileCount::laneOf(const T37 &t)
+{
+    return t.isAka5() ? AKA5_LANE + static_cast<int>(t.suit()) : t.id34();
+}
+
+///
+/// \brief Add the red five lanes of the suits whose 5 is in 'mask'
+///
+uint64_t PackedTileCount::withAka5(uint64_t mask)
+{
+    uint64_t m = (mask >> 4) & 1;
+    uint64_t p = (mask >> 13) & 1;
+    uint64_t s = (mask >> 22) & 1;
+    return mask | (m << AKA5_LANE) | (p << (AKA5_LANE + 1)) | (s << (AKA5_LANE + 2));
+}
+
+int PackedTileCount::lane(int i) const
+{
+    return static_cast<int>(((mPlanes[0] >> i) & 1)
+                            | (((mPlanes[1] >> i) & 1) << 1)
+                            | (((mPlanes[2] >> i) & 1) << 2));
+}
+
+void PackedTileCount::setLane(int i, int ct)
+{
+    assert(0 <= ct && ct <= MAX_CT);
+
+    uint64_t bit = uint64_t(1) << i;
+    for (int k = 0; k < 3; k++) {
+        if ((ct >> k) & 1)
+            mPlanes[k] |= bit;
+        else
+            mPlanes[k] &= ~bit;
+    }
+}
+
+///
+/// \brief Sum of the lanes selected by 'mask'
+///
+int PackedTileCount::weigh(uint64_t mask) const
+{
+    return popcount(mPlanes[0] & mask)
+           + 2 * popcount(mPlanes[1] & mask)
+           + 4 * popcount(mPlanes[2] & mask);
+}
+
+///
+/// \brief Lane-wise 'this - rhs' by a bit-sliced ripple subtractor
+/// \param diff Output difference planes, may alias 'mPlanes'
+/// \return Lanes where 'rhs' is greater than 'this'
+///
+uint64_t PackedTileCount::borrowOf(const PackedTileCount &rhs, std::array<uint64_t, 3> &diff) const
+{
+    uint64_t borrow = 0;
+
+    for (int k = 0; k < 3; k++) {
+        uint64_t a = mPlanes[k];
+        uint64_t b = rhs.mPlanes[k];
+        diff[k] = a ^ b ^ borrow;
+        borrow = (~a & b) | (~(a ^ b) & borrow);
+    }
+
+    return borrow & ALL_LANES;
+}
+
+
+
+} // namespace saki
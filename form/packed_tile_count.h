@@ -0,0 +1,78 @@
+#ifndef SAKI_PACKED_TILE_COUNT_H
+#define SAKI_PACKED_TILE_COUNT_H
+
+#include "tile_count.h"
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+
+
+
+namespace saki
+{
+
+
+
+///
+/// \brief Compact tile-count for cheap copies and whole-set queries
+///
+/// Each of the 37 lanes holds a count of 0~7 of one T37 kind: lane
+/// 'id34' for the non-red tiles, and lanes 34~36 for the red 5m/5p/5s.
+/// The lanes are stored bit-sliced, bit k of every lane in mPlanes[k],
+/// so that a whole instance is 24 bytes, and sums over a set of kinds
+/// are three masked popcounts while comparisons and subtractions are
+/// a few word-wide boolean operations.
+///
+/// Converts to and from TileCount losslessly.
+///
+class PackedTileCount
+{
+public:
+    static const int MAX_CT = 7;
+
+    PackedTileCount();
+    explicit PackedTileCount(const TileCount &count);
+
+    PackedTileCount(const PackedTileCount &copy) = default;
+    PackedTileCount &operator=(const PackedTileCount &assign) = default;
+
+    TileCount unpack() const;
+
+    int ct(T34 t) const;
+    int ct(const T37 &t) const;
+    int ct(Suit s) const;
+    int ct(const std::bitset<34> &ts) const;
+    int ctAka5() const;
+    int ctZ() const;
+    int ctYao() const;
+    int sum() const;
+
+    bool covers(const PackedTileCount &that) const;
+
+    void inc(const T37 &t, int delta);
+
+    PackedTileCount &operator-=(const PackedTileCount &rhs);
+    bool operator==(const PackedTileCount &that) const;
+    bool operator!=(const PackedTileCount &that) const;
+
+private:
+    static int laneOf(const T37 &t);
+    static uint64_t withAka5(uint64_t mask);
+
+    int lane(int i) const;
+    void setLane(int i, int ct);
+    int weigh(uint64_t mask) const;
+    uint64_t borrowOf(const PackedTileCount &rhs, std::array<uint64_t, 3> &diff) const;
+
+private:
+    std::array<uint64_t, 3> mPlanes;
+};
+
+
+
+} // namespace saki
+
+
+
+#endif // SAKI_PACKED_TILE_COUNT_H
@@ -0,0 +1,183 @@
+#include "parse_cache.h"
+
+#include <cassert>
+
+
+
+namespace saki
+{
+
+
+
+///
+/// \brief Get the cache shared by all tables in the process
+///
+ParseCache &ParseCache::instance()
+{
+    static ParseCache cache;
+    return cache;
+}
+
+///
+/// \brief Pack 34 counts of 3 bits and the bark count into a key
+///
+ParseCache::Key ParseCache::keyOf(const std::array<int, 34> &counts, int barkCt)
+{
+    assert(0 <= barkCt && barkCt <= 4);
+
+    Key key { 0, 0 };
+    for (int ti = 0; ti < 34; ti++) {
+        assert(0 <= counts[ti] && counts[ti] <= 7);
+        uint64_t c = static_cast<uint64_t>(counts[ti]);
+        if (ti < 21)
+            key.lo |= c << (3 * ti);
+        else
+            key.hi |= c << (3 * (ti - 21));
+    }
+
+    key.hi |= static_cast<uint64_t>(barkCt) << 39;
+    return key;
+}
+
+///
+/// \return The cached result, sharing the stored one, or nothing if not cached
+///
+std::optional<Parsed4s> ParseCache::find(const Key &key)
+{
+    if (capacity() == 0)
+        return std::nullopt;
+
+    Shard &shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+        shard.misses++;
+        return std::nullopt;
+    }
+
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    shard.hits++;
+    return it->second->second;
+}
+
+void ParseCache::insert(const Key &key, const Parsed4s &parseds)
+{
+    size_t cap = shardCapacity();
+    if (cap == 0)
+        return;
+
+    Shard &shard = shardOf(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.index.count(key) > 0)
+        return; // inserted by another thread meanwhile
+
+    shard.lru.emplace_front(key, parseds);
+    shard.index.emplace(key, shard.lru.begin());
+    shrink(shard, cap);
+}
+
+///
+/// \brief Set the max number of entries, 0 to disable the cache
+///
+void ParseCache::setCapacity(size_t capacity)
+{
+    mCapacity = capacity;
+
+    size_t cap = shardCapacity();
+    for (Shard &shard : mShards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shrink(shard, cap);
+    }
+}
+
+size_t ParseCache::capacity() const
+{
+    return mCapacity;
+}
+
+size_t ParseCache::size() const
+{
+    size_t res = 0;
+    for (const Shard &shard : mShards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        res += shard.index.size();
+    }
+
+    return res;
+}
+
+void ParseCache::clear()
+{
+    for (Shard &shard : mShards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.index.clear();
+        shard.lru.clear();
+    }
+}
+
+uint64_t ParseCache::hits() const
+{
+    uint64_t res = 0;
+    for (const Shard &shard : mShards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        res += shard.hits;
+    }
+
+    return res;
+}
+
+uint64_t ParseCache::misses() const
+{
+    uint64_t res = 0;
+    for (const Shard &shard : mShards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        res += shard.misses;
+    }
+
+    return res;
+}
+
+void ParseCache::resetStats()
+{
+    for (Shard &shard : mShards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.hits = 0;
+        shard.misses = 0;
+    }
+}
+
+size_t ParseCache::KeyHash::operator()(const Key &key) const
+{
+    // splitmix64 finalizer over the two words
+    uint64_t x = key.lo ^ (key.hi * 0x9e3779b97f4a7c15ULL);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return static_cast<size_t>(x ^ (x >> 31));
+}
+
+ParseCache::Shard &ParseCache::shardOf(const Key &key)
+{
+    return mShards[(KeyHash()(key) >> 7) & (NUM_SHARD - 1)];
+}
+
+size_t ParseCache::shardCapacity() const
+{
+    size_t cap = capacity();
+    return (cap + NUM_SHARD - 1) / NUM_SHARD;
+}
+
+///
+/// \brief Evict least recently used entries until 'capacity' is met
+/// \pre Caller holds the lock of 'shard'
+///
+void ParseCache::shrink(Shard &shard, size_t capacity)
+{
+    while (shard.index.size() > capacity) {
+        shard.index.erase(shard.lru.back().first);
+        shard.lru.pop_back();
+    }
+}
+
+
+
+} // namespace saki
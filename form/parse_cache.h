@@ -0,0 +1,107 @@
+#ifndef SAKI_PARSE_CACHE_H
+#define SAKI_PARSE_CACHE_H
+
+#include "parsed.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+
+
+namespace saki
+{
+
+
+
+///
+/// \brief Process-wide bounded LRU cache of TileCount::parse4() results
+///
+/// Keyed by the exact 34-kind counts and the bark count, packed into two
+/// words, so different hands never share an entry. Entries are split
+/// into shards, each guarded by its own mutex, so that tables running in
+/// different threads rarely contend.
+///
+/// Parsed4s share their immutable results between copies, so a hit
+/// hands out the stored results without copying or allocating.
+///
+class ParseCache
+{
+public:
+    struct Key
+    {
+        uint64_t lo;
+        uint64_t hi;
+
+        bool operator==(const Key &that) const
+        {
+            return lo == that.lo && hi == that.hi;
+        }
+    };
+
+    static const size_t DEFAULT_CAPACITY = 1 << 14;
+
+    static ParseCache &instance();
+    static Key keyOf(const std::array<int, 34> &counts, int barkCt);
+
+    ParseCache(const ParseCache &copy) = delete;
+    ParseCache &operator=(const ParseCache &assign) = delete;
+
+    std::optional<Parsed4s> find(const Key &key);
+    void insert(const Key &key, const Parsed4s &parseds);
+
+    void setCapacity(size_t capacity);
+    size_t capacity() const;
+    size_t size() const;
+    void clear();
+
+    uint64_t hits() const;
+    uint64_t misses() const;
+    void resetStats();
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const;
+    };
+
+    using Entry = std::pair<Key, Parsed4s>;
+
+    ///
+    /// Aligned to a cache line, and counting its own hits and misses
+    /// under its lock, so that threads on different shards never write
+    /// to the same line.
+    ///
+    struct alignas(64) Shard
+    {
+        mutable std::mutex mutex;
+        std::list<Entry> lru; ///< Most recently used at front
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+
+    static const int NUM_SHARD = 16;
+
+    ParseCache() = default;
+
+    Shard &shardOf(const Key &key);
+    size_t shardCapacity() const;
+    static void shrink(Shard &shard, size_t capacity);
+
+private:
+    std::array<Shard, NUM_SHARD> mShards;
+    std::atomic<size_t> mCapacity { DEFAULT_CAPACITY };
+};
+
+
+
+} // namespace saki
+
+
+
+#endif // SAKI_PARSE_CACHE_H
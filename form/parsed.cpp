@@ -94,6 +94,22 @@ util::Stactor<T34, 9> Parsed4::claim3sk() const
     return res;
 }
 
+///
+/// \brief Map this result through a suit permutation, caches included
+///
+Parsed4 Parsed4::permuted(const SuitPerm &perm) const
+{
+    Heads heads;
+    for (const C34 &c : mHeads)
+        heads.pushBack(perm(c));
+
+    Parsed4 res(heads, mBarkCt);
+    if (mEffA4SetCache.has_value())
+        res.mEffA4SetCache = perm(*mEffA4SetCache);
+
+    return res;
+}
+
 /// \brief ordered equal, not set equal
 bool Parsed4::operator==(const Parsed4 &that) const
 {
@@ -168,39 +184,40 @@ void Parsed4::computeEffA4() const
 /// \brief Contruct from raw data
 /// \param parseds Must have same shanten number for all element, w/o duplication
 ///
+/// Caches of the results are filled here, as they are never written
+/// once shared.
+///
 Parsed4s::Parsed4s(Parsed4s::Container &&parseds)
-    : mParseds(parseds)
 {
-}
+    for (const Parsed4 &p : parseds)
+        mEffA4Set |= p.effA4Set();
 
-const Parsed4s::Container &Parsed4s::data() const
-{
-    return mParseds;
+    mParseds = std::make_shared<const Container>(std::move(parseds));
 }
 
 int Parsed4s::size() const
 {
-    return mParseds.size();
+    return mParseds->size();
 }
 
 int Parsed4s::barkCt() const
 {
-    return mParseds.front().barkCt();
+    return mParseds->front().barkCt();
 }
 
-auto Parsed4s::begin() const -> Container::const_iterator
+Parsed4s::Iterator Parsed4s::begin() const
 {
-    return mParseds.begin();
+    return Iterator(mParseds->begin(), mPerm);
 }
 
-auto Parsed4s::end() const -> Container::const_iterator
+Parsed4s::Iterator Parsed4s::end() const
 {
-    return mParseds.end();
+    return Iterator(mParseds->end(), mPerm);
 }
 
 int Parsed4s::step4() const
 {
-    return mParseds.front().step4();
+    return mParseds->front().step4();
 }
 
 
@@ -216,15 +233,45 @@ util::Stactor<T34, 34> Parsed4s::effA4() const
 
 std::bitset<34> Parsed4s::effA4Set() const
 {
-    if (!mEffA4SetCache.has_value()) {
-        std::bitset<34> effA;
-        for (const Parsed4 &p : mParseds)
-            effA |= p.effA4Set();
+    return mEffA4Set;
+}
 
-        mEffA4SetCache = effA;
-    }
+///
+/// \brief Map all results through a suit permutation, sharing the results
+///
+Parsed4s Parsed4s::permuted(const SuitPerm &perm) const
+{
+    Parsed4s res(*this);
+    res.mPerm = perm(mPerm);
+    res.mEffA4Set = perm(mEffA4Set);
+    return res;
+}
 
-    return *mEffA4SetCache;
+Parsed4s::Iterator::Iterator(Container::const_iterator it, const SuitPerm &perm)
+    : mIt(it)
+    , mPerm(perm)
+{
+}
+
+Parsed4 Parsed4s::Iterator::operator*() const
+{
+    return mPerm.isIdentity() ? *mIt : mIt->permuted(mPerm);
+}
+
+Parsed4s::Iterator &Parsed4s::Iterator::operator++()
+{
+    ++mIt;
+    return *this;
+}
+
+bool Parsed4s::Iterator::operator==(const Iterator &that) const
+{
+    return mIt == that.mIt;
+}
+
+bool Parsed4s::Iterator::operator!=(const Iterator &that) const
+{
+    return mIt != that.mIt;
 }
 
 
@@ -1,8 +1,10 @@
 #ifndef SAKI_PARSED_H
 #define SAKI_PARSED_H
 
-#include "../unit/comeld.h"
+#include "suit_perm.h"
 
+#include <iterator>
+#include <memory>
 #include <optional>
 #include <vector>
 
@@ -30,6 +32,8 @@ public:
 
     util::Stactor<T34, 9> claim3sk() const;
 
+    Parsed4 permuted(const SuitPerm &perm) const;
+
     bool operator==(const Parsed4 &that) const;
 
 private:
@@ -53,26 +57,55 @@ inline std::ostream &operator<<(std::ostream &os, const Parsed4 &p)
 
 
 
+///
+/// \brief Immutable 4-meld results shared by all copies
+///
+/// Copies share one container, so copying costs no allocation. A suit
+/// permutation is kept aside and applied to each result as it is read.
+///
 class Parsed4s
 {
 public:
     using Container = std::vector<Parsed4>;
 
+    class Iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Parsed4;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Parsed4;
+
+        explicit Iterator(Container::const_iterator it, const SuitPerm &perm);
+
+        Parsed4 operator*() const;
+        Iterator &operator++();
+        bool operator==(const Iterator &that) const;
+        bool operator!=(const Iterator &that) const;
+
+    private:
+        Container::const_iterator mIt;
+        SuitPerm mPerm;
+    };
+
     explicit Parsed4s(Container &&parseds);
 
-    const Container &data() const;
     int size() const;
     int barkCt() const;
-    Container::const_iterator begin() const;
-    Container::const_iterator end() const;
+    Iterator begin() const;
+    Iterator end() const;
 
     int step4() const;
     util::Stactor<T34, 34> effA4() const;
     std::bitset<34> effA4Set() const;
 
+    Parsed4s permuted(const SuitPerm &perm) const;
+
 private:
-    Container mParseds;
-    mutable std::optional<std::bitset<34>> mEffA4SetCache;
+    std::shared_ptr<const Container> mParseds;
+    SuitPerm mPerm;
+    std::bitset<34> mEffA4Set;
 };
 
 
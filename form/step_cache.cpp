@@ -0,0 +1,280 @@
+#include "step_cache.h"
+#include "hand.h"
+#include "../util/misc.h"
+
+#include <atomic>
+#include <cassert>
+
+
+
+namespace saki
+{
+
+
+
+///
+/// \brief Report a change of the count of 't', either closed or drawn
+///
+void StepCache::touch(T34 t)
+{
+    mDirty.set(StepTable::suitIndex(t));
+    mHasMerged = false;
+    mHasOthers = false;
+    mHasEffA4 = false;
+}
+
+///
+/// \brief Get the same value as TileCount::step4() of the hand
+/// \return False if the hand is out of the step table
+///
+bool StepCache::step4(const Hand &hand, int &step)
+{
+    if (!sync(hand))
+        return false;
+
+    if (!mHasMerged) {
+        Lookups &own = this->own();
+        own.merged = StepTable::merge(own.suits);
+        mHasMerged = true;
+    }
+
+    step = StepTable::step4(mLookups->merged, hand.barks().size());
+    return true;
+}
+
+///
+/// \brief Get the set of tiles decreasing step4() of the hand
+/// \return False if the hand, or the hand after a draw, is out of the table
+///
+/// Same as TileCount::effA4Set(), including the drawn tile if any
+///
+bool StepCache::effA4Set(const Hand &hand, std::bitset<34> &effA)
+{
+    int barkCt = hand.barks().size();
+    int curr;
+    if (!step4(hand, curr))
+        return false;
+
+    if (mHasEffA4 && mLookups->effA4BarkCt == barkCt) {
+        effA = mLookups->effA4;
+        return true;
+    }
+
+    const std::array<StepTable::Merged, 4> &others = this->others();
+    const Lookups &lookups = *mLookups;
+
+    effA.reset();
+
+    for (T34 t : tiles34::ALL34) {
+        if (!lookups.likes[t.id34()])
+            continue;
+
+        // one parse4() beats cutting once per draw out of the table
+        const StepTable::Works *drawn = lookups.draws[t.id34()];
+        if (drawn == nullptr)
+            return false;
+
+        int next = StepTable::step4(others[StepTable::suitIndex(t)], *drawn, barkCt);
+        effA[t.id34()] = next < curr;
+    }
+
+    Lookups &own = this->own();
+    own.effA4 = effA;
+    own.effA4BarkCt = barkCt;
+    mHasEffA4 = true;
+    return true;
+}
+
+///
+/// \brief Get step4() of the hand after discarding 'out'
+/// \return False if the lookup is out of the step table
+///
+/// Only the suit of 'out' is looked up, cheap enough to filter out
+/// discards before calling discard4().
+///
+bool StepCache::discardStep4(const Hand &hand, T34 out, int &step)
+{
+    if (!sync(hand))
+        return false;
+
+    const int so = StepTable::suitIndex(out);
+
+    Counts c = countSuit(hand, so);
+    assert(c[out.id34() - 9 * so] > 0);
+    c[out.id34() - 9 * so]--;
+
+    const StepTable::Works *works = lookup(so, c);
+    if (works == nullptr)
+        return false;
+
+    step = StepTable::step4(others()[so], *works, hand.barks().size());
+    return true;
+}
+
+///
+/// \brief Get step4() and effA4Set() of the hand after discarding 'out'
+/// \return False if the hand after the discard, or after one more draw, is out of the table
+///
+/// Lookups of the suits other than the one of 'out' are shared with
+/// the current hand, so that evaluating all discards of a drawn hand
+/// only re-looks-up one suit per candidate.
+///
+bool StepCache::discard4(const Hand &hand, T34 out, int &step, std::bitset<34> &effA)
+{
+    if (!sync(hand))
+        return false;
+
+    const int barkCt = hand.barks().size();
+    const int so = StepTable::suitIndex(out);
+
+    Counts c = countSuit(hand, so);
+    assert(c[out.id34() - 9 * so] > 0);
+    c[out.id34() - 9 * so]--;
+
+    const StepTable::Merged &otherSo = this->others()[so];
+    const Lookups &curr = *mLookups;
+
+    StepTable::Suits suits = curr.suits;
+    std::array<const StepTable::Works *, StepTable::NUM_KIND> draws;
+    std::bitset<34> likes = curr.likes;
+    scanSuit(so, c, suits[so], draws.data(), likes);
+    if (suits[so] == nullptr)
+        return false;
+
+    std::array<StepTable::Merged, 4> others;
+    others[so] = otherSo;
+    for (int s = 0; s < 4; s++)
+        if (s != so)
+            others[s] = StepTable::mergeExcept(suits, s);
+
+    step = StepTable::step4(others[so], *suits[so], barkCt);
+
+    effA.reset();
+
+    for (T34 t : tiles34::ALL34) {
+        if (!likes[t.id34()])
+            continue;
+
+        int s = StepTable::suitIndex(t);
+        const StepTable::Works *drawn = s == so ? draws[t.id34() - 9 * s] : curr.draws[t.id34()];
+        if (drawn == nullptr)
+            return false;
+
+        int next = StepTable::step4(others[s], *drawn, barkCt);
+        effA[t.id34()] = next < step;
+    }
+
+    return true;
+}
+
+///
+/// \brief Get the lookups to write, allocated or unshared if needed
+///
+StepCache::Lookups &StepCache::own()
+{
+    if (mLookups == nullptr || mLookups.use_count() > 1) {
+        mLookups = mLookups == nullptr ? std::make_shared<Lookups>()
+                                       : std::make_shared<Lookups>(*mLookups);
+    } else {
+        // pairs with the release by the last other owner dropping it
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+
+    return *mLookups;
+}
+
+///
+/// \brief Re-look-up dirty suits
+/// \return False if any suit is out of the table
+///
+bool StepCache::sync(const Hand &hand)
+{
+    if (mDirty.any()) {
+        Lookups &own = this->own();
+        for (int s = 0; s < 4; s++) {
+            if (mDirty[s]) {
+                Counts c = countSuit(hand, s);
+                scanSuit(s, c, own.suits[s], &own.draws[9 * s], own.likes);
+            }
+        }
+
+        mDirty.reset();
+    }
+
+    return util::all(mLookups->suits, [](const StepTable::Works *w) { return w != nullptr; });
+}
+
+///
+/// \brief Merged works of all suits but each one, of synced lookups
+///
+const std::array<StepTable::Merged, 4> &StepCache::others()
+{
+    if (!mHasOthers) {
+        Lookups &own = this->own();
+        for (int s = 0; s < 4; s++)
+            own.others[s] = StepTable::mergeExcept(own.suits, s);
+
+        mHasOthers = true;
+    }
+
+    return mLookups->others;
+}
+
+///
+/// \brief Counts of the closed tiles plus the drawn one in suit 's'
+///
+StepCache::Counts StepCache::countSuit(const Hand &hand, int s)
+{
+    const int kind = s < 3 ? StepTable::NUM_KIND : StepTable::HONOR_KIND;
+
+    Counts c;
+    c.fill(0);
+    for (int i = 0; i < kind; i++) {
+        T34 t(9 * s + i);
+        c[i] = hand.closed().ct(t) + (hand.hasDrawn() && hand.drawn() == t);
+    }
+
+    return c;
+}
+
+const StepTable::Works *StepCache::lookup(int s, const Counts &c)
+{
+    const StepTable &table = StepTable::instance();
+    return s < 3 ? table.num(c.data()) : table.honor(c.data());
+}
+
+///
+/// \brief Look up suit 's' and all its one-more-tile neighbors
+/// \param c Counts of the suit, restored before return
+/// \param works Output lookup of 'c'
+/// \param draws Output lookups after drawing each kind in the suit
+/// \param likes Output, only the bits of the suit are written
+///
+void StepCache::scanSuit(int s, Counts &c, const StepTable::Works *&works,
+                         const StepTable::Works **draws, std::bitset<34> &likes)
+{
+    const bool num = s < 3;
+    const int begin = 9 * s;
+    const int kind = num ? StepTable::NUM_KIND : StepTable::HONOR_KIND;
+
+    works = lookup(s, c);
+
+    for (int i = 0; i < kind; i++) {
+        c[i]++;
+        draws[i] = lookup(s, c);
+        c[i]--;
+
+        // same as TileCount::dislike4()
+        bool like = c[i] > 0;
+        if (num) {
+            like = like
+                || (i >= 1 && c[i - 1] > 0) || (i <= 7 && c[i + 1] > 0)
+                || (i >= 2 && c[i - 2] > 0) || (i <= 6 && c[i + 2] > 0);
+        }
+
+        likes[begin + i] = like;
+    }
+}
+
+
+} // namespace saki
@@ -0,0 +1,83 @@
+#ifndef SAKI_STEP_CACHE_H
+#define SAKI_STEP_CACHE_H
+
+#include "step_table.h"
+
+#include <bitset>
+#include <memory>
+
+
+
+namespace saki
+{
+
+
+
+class Hand;
+
+
+
+///
+/// \brief Incrementally maintained step-table lookups of a hand
+///
+/// The owner reports every single-tile delta by touch(), which only
+/// marks the suit of the tile as dirty. Queries re-look-up dirty suits
+/// only, together with the lookups of "one more tile" of that suit
+/// used by effective tile queries. Lookups of the other suits are kept.
+///
+/// The lookups are allocated at the first query and shared by copies
+/// until one of them writes, so a copied hand costs one pointer here
+/// and a hand never queried costs no lookups at all.
+///
+class StepCache
+{
+public:
+    StepCache() = default;
+
+    StepCache(const StepCache &copy) = default;
+    StepCache &operator=(const StepCache &assign) = default;
+
+    void touch(T34 t);
+
+    bool step4(const Hand &hand, int &step);
+    bool effA4Set(const Hand &hand, std::bitset<34> &effA);
+    bool discardStep4(const Hand &hand, T34 out, int &step);
+    bool discard4(const Hand &hand, T34 out, int &step, std::bitset<34> &effA);
+
+private:
+    using Counts = std::array<int, StepTable::NUM_KIND>;
+
+    struct Lookups
+    {
+        StepTable::Suits suits;
+        std::array<const StepTable::Works *, 34> draws; ///< Lookups after drawing each tile
+        std::bitset<34> likes; ///< Negation of TileCount::dislike4()
+        StepTable::Merged merged;
+        std::array<StepTable::Merged, 4> others; ///< By mergeExcept()
+        std::bitset<34> effA4;
+        int effA4BarkCt;
+    };
+
+    Lookups &own();
+    bool sync(const Hand &hand);
+    const std::array<StepTable::Merged, 4> &others();
+
+    static Counts countSuit(const Hand &hand, int s);
+    static const StepTable::Works *lookup(int s, const Counts &c);
+    static void scanSuit(int s, Counts &c, const StepTable::Works *&works,
+                         const StepTable::Works **draws, std::bitset<34> &likes);
+
+private:
+    std::shared_ptr<Lookups> mLookups;
+    std::bitset<4> mDirty { 0b1111 };
+    bool mHasMerged = false;
+    bool mHasOthers = false;
+    bool mHasEffA4 = false;
+};
+
+
+} // namespace saki
+
+
+
+#endif // SAKI_STEP_CACHE_H
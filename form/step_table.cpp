@@ -0,0 +1,319 @@
+#include "step_table.h"
+#include "step_table_file.h"
+
+#include <algorithm>
+#include <functional>
+#include <cassert>
+
+
+
+namespace saki
+{
+
+
+
+///
+/// \brief Get the process-wide table, built or mapped at the first call
+///
+const StepTable &StepTable::instance()
+{
+    static const StepTable table(StepTableFile::seal());
+    return table;
+}
+
+///
+/// \brief Distribute blocks between the merged suits and one more suit
+///
+StepTable::Merged StepTable::merge(const Merged &merged, const Works &works)
+{
+    Merged res;
+
+    for (int b = 0; b <= 4; b++) {
+        for (int i = 0; i <= b; i++) {
+            int f = works.free[b - i];
+            int h = works.headed[b - i];
+            res.free[b] = std::max(res.free[b], merged.free[i] + f);
+            res.headed[b] = std::max(res.headed[b], std::max(merged.headed[i] + f,
+                                                             merged.free[i] + h));
+        }
+    }
+
+    return res;
+}
+
+///
+/// \param suits Works of m, p, s, and honors, all non-null
+///
+StepTable::Merged StepTable::merge(const Suits &suits)
+{
+    Merged res;
+    for (const Works *w : suits)
+        res = merge(res, *w);
+
+    return res;
+}
+
+///
+/// \brief Merge all suits but 'suits[except]'
+///
+/// Useful when only one suit is going to change
+///
+StepTable::Merged StepTable::mergeExcept(const Suits &suits, int except)
+{
+    Merged res;
+    for (int s = 0; s < 4; s++)
+        if (s != except)
+            res = merge(res, *suits[s]);
+
+    return res;
+}
+
+///
+/// \brief Get the 4-meld step from the works of all the four suits
+/// \param merged Merged works of m, p, s, and honors
+/// \param barkCt Number of barks
+/// \return Same as TileCount::step4(barkCt)
+///
+int StepTable::step4(const Merged &merged, int barkCt)
+{
+    assert(0 <= barkCt && barkCt <= 4);
+
+    const int maxCut = 4 - barkCt;
+    int res = 8 - merged.free[maxCut];
+    if (merged.headed[maxCut] >= 0)
+        res = std::min(res, 7 - merged.headed[maxCut]);
+
+    return res - 2 * barkCt;
+}
+
+///
+/// \brief Same as step4(merge(merged, works), barkCt)
+///
+/// Only merges the block count actually used, which is the hot path
+/// of effective tile queries where one suit is tried many times.
+///
+int StepTable::step4(const Merged &merged, const Works &works, int barkCt)
+{
+    assert(0 <= barkCt && barkCt <= 4);
+
+    const int maxCut = 4 - barkCt;
+    int free = 0;
+    int headed = WORK_NONE;
+    for (int i = 0; i <= maxCut; i++) {
+        int f = works.free[maxCut - i];
+        int h = works.headed[maxCut - i];
+        free = std::max(free, merged.free[i] + f);
+        headed = std::max(headed, std::max(merged.headed[i] + f, merged.free[i] + h));
+    }
+
+    int res = 8 - free;
+    if (headed >= 0)
+        res = std::min(res, 7 - headed);
+
+    return res - 2 * barkCt;
+}
+
+int StepTable::step4(const Suits &suits, int barkCt)
+{
+    return step4(merge(suits), barkCt);
+}
+
+///
+/// \brief Same as step4() but only count the birdhead-less case
+///
+int StepTable::step4Birdless(const Merged &merged, int barkCt)
+{
+    assert(0 <= barkCt && barkCt <= 4);
+    return 8 - merged.free[4 - barkCt] - 2 * barkCt;
+}
+
+int StepTable::step4Birdless(const Suits &suits, int barkCt)
+{
+    return step4Birdless(merge(suits), barkCt);
+}
+
+///
+/// \brief Look up a number suit
+/// \param counts Counts of the 9 kinds in the suit
+/// \return Null if the counts are out of the table
+///
+const StepTable::Works *StepTable::num(const int *counts) const
+{
+    int r = rank(counts, NUM_KIND);
+    return r < 0 ? nullptr : &mNums[r];
+}
+
+///
+/// \brief Look up the honors
+/// \param counts Counts of the 7 kinds of honors
+/// \return Null if the counts are out of the table
+///
+const StepTable::Works *StepTable::honor(const int *counts) const
+{
+    int r = rank(counts, HONOR_KIND);
+    return r < 0 ? nullptr : &mHonors[r];
+}
+
+///
+/// \param file Use the data of it if not null, otherwise build the data
+///
+StepTable::StepTable(const StepTableFile *file)
+{
+    // number of vectors by [kind][max sum]
+    std::array<std::array<int, MAX_SUM + 1>, NUM_KIND + 1> ns;
+    ns[0].fill(1);
+    for (int k = 1; k <= NUM_KIND; k++) {
+        for (int s = 0; s <= MAX_SUM; s++) {
+            ns[k][s] = 0;
+            for (int x = 0; x <= std::min(4, s); x++)
+                ns[k][s] += ns[k - 1][s - x];
+        }
+    }
+
+    for (int k = 0; k < NUM_KIND; k++) {
+        for (int s = 0; s <= MAX_SUM; s++) {
+            mRankBase[k][s][0] = 0;
+            for (int c = 1; c <= 4; c++)
+                mRankBase[k][s][c] = mRankBase[k][s][c - 1] + (c - 1 <= s ? ns[k][s - (c - 1)] : 0);
+        }
+    }
+
+    mNumCt = ns[NUM_KIND][MAX_SUM];
+    mHonorCt = ns[HONOR_KIND][MAX_SUM];
+
+    if (file != nullptr) {
+        assert(file->numCt() == mNumCt && file->honorCt() == mHonorCt);
+        mNums = file->nums();
+        mHonors = file->honors();
+        return;
+    }
+
+    mOwnNums.resize(mNumCt);
+    build(mOwnNums, NUM_KIND, true);
+    mNums = mOwnNums.data();
+
+    mOwnHonors.resize(mHonorCt);
+    build(mOwnHonors, HONOR_KIND, false);
+    mHonors = mOwnHonors.data();
+}
+
+///
+/// \brief Lexicographical rank among vectors of the same kind in the table
+/// \return -1 if the vector is out of the table
+///
+int StepTable::rank(const int *counts, int kind) const
+{
+    int res = 0;
+    int remain = MAX_SUM;
+
+    for (int i = 0; i < kind; i++) {
+        int c = counts[i];
+        if (c > 4 || c > remain)
+            return -1;
+
+        res += mRankBase[kind - 1 - i][remain][c];
+        remain -= c;
+    }
+
+    return res;
+}
+
+void StepTable::build(std::vector<Works> &table, int kind, bool seq)
+{
+    std::array<int, NUM_KIND> c;
+    c.fill(0);
+
+    // *INDENT-OFF*
+    std::function<void(int, int)> fill = [&](int i, int remain) {
+        if (i == kind) {
+            if (remain == 0)
+                table[rank(c.data(), kind)] = compute(table, c, kind, seq);
+            return;
+        }
+
+        if (remain > 4 * (kind - i))
+            return;
+
+        for (int x = 0; x <= std::min(4, remain); x++) {
+            c[i] = x;
+            fill(i + 1, remain - x);
+        }
+
+        c[i] = 0;
+    };
+    // *INDENT-ON*
+
+    // smaller sums first, so that all sub-vectors are ready when used
+    for (int sum = 0; sum <= MAX_SUM; sum++)
+        fill(0, sum);
+}
+
+///
+/// \brief Compute works of a vector from its already computed sub-vectors
+///
+/// At the first non-empty kind, either drop one tile as a floating
+/// tile, or cut a comeld starting from it. This enumerates the same
+/// space as TileCount::cutMeld() followed by TileCount::cutSubmeld().
+///
+StepTable::Works StepTable::compute(const std::vector<Works> &table,
+                                    std::array<int, NUM_KIND> &c, int kind, bool seq) const
+{
+    Works res;
+    res.free.fill(0);
+    res.headed.fill(WORK_NONE);
+
+    int i = 0;
+    while (i < kind && c[i] == 0)
+        i++;
+
+    if (i == kind)
+        return res;
+
+    // *INDENT-OFF*
+    auto without = [&](std::initializer_list<int> ids) -> const Works & {
+        for (int id : ids)
+            c[id]--;
+        const Works &sub = table[rank(c.data(), kind)];
+        for (int id : ids)
+            c[id]++;
+        return sub;
+    };
+
+    auto cut = [&](int work, std::initializer_list<int> ids) {
+        const Works &sub = without(ids);
+        for (int b = 1; b <= 4; b++)
+            res.free[b] = std::max<int>(res.free[b], work + sub.free[b - 1]);
+    };
+    // *INDENT-ON*
+
+    res.free = without({ i }).free;
+
+    if (c[i] >= 3)
+        cut(2, { i, i, i });
+
+    if (seq && i + 2 < kind && c[i + 1] > 0 && c[i + 2] > 0)
+        cut(2, { i, i + 1, i + 2 });
+
+    if (c[i] >= 2)
+        cut(1, { i, i });
+
+    if (seq && i + 1 < kind && c[i + 1] > 0)
+        cut(1, { i, i + 1 });
+
+    if (seq && i + 2 < kind && c[i + 2] > 0)
+        cut(1, { i, i + 2 });
+
+    for (int j = i; j < kind; j++) {
+        if (c[j] >= 2) {
+            const Works &sub = without({ j, j });
+            for (int b = 0; b <= 4; b++)
+                res.headed[b] = std::max(res.headed[b], sub.free[b]);
+        }
+    }
+
+    return res;
+}
+
+
+
+} // namespace saki
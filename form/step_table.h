@@ -0,0 +1,118 @@
+#ifndef SAKI_STEP_TABLE_H
+#define SAKI_STEP_TABLE_H
+
+#include "../unit/tile.h"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <cstdint>
+
+
+
+namespace saki
+{
+
+
+
+class StepTableFile;
+
+
+
+///
+/// \brief Precomputed per-suit cutting results for the table-driven step4
+///
+/// Comelds never cross suits, so the 4-meld step of a hand can be
+/// combined from the best works of each suit independently.
+/// For every count vector of a number suit (9 kinds) and of the
+/// honors (7 kinds) that sums up to at most MAX_SUM, the table stores
+/// the max work achievable by cutting at most 0~4 melds or submelds,
+/// both with and without a bird-head taken out of that suit.
+///
+/// Count vectors out of the table (count > 4 or sum > MAX_SUM) are
+/// reported by a null lookup, callers should fall back to cutting.
+///
+/// The process-wide instance is built at its first use, unless a
+/// table file is loaded by StepTableFile::load() before that.
+///
+class StepTable
+{
+public:
+    static const int MAX_SUM = 14;
+    static const int NUM_KIND = 9;
+    static const int HONOR_KIND = 7;
+    static constexpr int8_t WORK_NONE = -64; ///< Negative enough to stay negative in sums
+
+    struct Works
+    {
+        std::array<int8_t, 5> free; ///< Max work by at most i blocks
+        std::array<int8_t, 5> headed; ///< Same as 'free' but with a bird-head cut out
+    };
+
+    using Suits = std::array<const Works *, 4>;
+
+    ///
+    /// \brief Works of several suits merged together
+    ///
+    /// A default constructed one merges no suit
+    ///
+    struct Merged
+    {
+        std::array<int, 5> free { 0, 0, 0, 0, 0 };
+        std::array<int, 5> headed { WORK_NONE, WORK_NONE, WORK_NONE, WORK_NONE, WORK_NONE };
+    };
+
+    static const StepTable &instance();
+
+    ///
+    /// \brief Index of the suit of 't' in Suits
+    ///
+    static int suitIndex(T34 t)
+    {
+        return std::min(t.id34() / 9, 3);
+    }
+
+    static Merged merge(const Merged &merged, const Works &works);
+    static Merged merge(const Suits &suits);
+    static Merged mergeExcept(const Suits &suits, int except);
+
+    static int step4(const Merged &merged, int barkCt);
+    static int step4(const Merged &merged, const Works &works, int barkCt);
+    static int step4(const Suits &suits, int barkCt);
+    static int step4Birdless(const Merged &merged, int barkCt);
+    static int step4Birdless(const Suits &suits, int barkCt);
+
+    StepTable(const StepTable &copy) = delete;
+    StepTable &operator=(const StepTable &assign) = delete;
+
+    const Works *num(const int *counts) const;
+    const Works *honor(const int *counts) const;
+
+private:
+    friend class StepTableFile;
+
+    explicit StepTable(const StepTableFile *file);
+
+    int rank(const int *counts, int kind) const;
+    void build(std::vector<Works> &table, int kind, bool seq);
+    Works compute(const std::vector<Works> &table, std::array<int, NUM_KIND> &c,
+                  int kind, bool seq) const;
+
+private:
+    /// [kind][remaining sum][count], number of smaller vectors
+    std::array<std::array<std::array<int, 5>, MAX_SUM + 1>, NUM_KIND> mRankBase;
+    int mNumCt;
+    int mHonorCt;
+    std::vector<Works> mOwnNums; ///< Empty if using a file
+    std::vector<Works> mOwnHonors; ///< Empty if using a file
+    const Works *mNums;
+    const Works *mHonors;
+};
+
+
+
+} // namespace saki
+
+
+
+#endif // SAKI_STEP_TABLE_H
@@ -0,0 +1,225 @@
+#include "step_table_file.h"
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SAKI_STEP_TABLE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+
+namespace saki
+{
+
+
+
+namespace
+{
+
+const char MAGIC[8] = { 'S', 'A', 'K', 'I', 'S', 'T', 'E', 'P' };
+
+/// Null, sealed(), or the loaded file
+std::atomic<StepTableFile *> sLoaded { nullptr };
+
+///
+/// \brief Mark of the step table built without a file
+///
+StepTableFile *sealed()
+{
+    static char mark;
+    return reinterpret_cast<StepTableFile *>(&mark);
+}
+
+} // namespace
+
+
+
+///
+/// \brief Build the step table in-process and write it to 'path'
+/// \return False on I/O failure
+///
+bool StepTableFile::write(const char *path)
+{
+    StepTable table(nullptr);
+
+    size_t numBytes = sizeof(StepTable::Works) * table.mNumCt;
+    size_t honorBytes = sizeof(StepTable::Works) * table.mHonorCt;
+
+    std::vector<unsigned char> payload(numBytes + honorBytes);
+    std::memcpy(payload.data(), table.mNums, numBytes);
+    std::memcpy(payload.data() + numBytes, table.mHonors, honorBytes);
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.maxSum = StepTable::MAX_SUM;
+    header.numKind = StepTable::NUM_KIND;
+    header.honorKind = StepTable::HONOR_KIND;
+    header.worksSize = sizeof(StepTable::Works);
+    header.numCt = table.mNumCt;
+    header.honorCt = table.mHonorCt;
+    header.checksum = checksumOf(payload.data(), payload.size());
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(payload.data()), payload.size());
+    return static_cast<bool>(out);
+}
+
+///
+/// \brief Open and validate a file written by write()
+/// \return Null if the file is unreadable or invalid
+///
+std::unique_ptr<StepTableFile> StepTableFile::read(const char *path)
+{
+    std::unique_ptr<StepTableFile> file(new StepTableFile());
+    if (!file->open(path) || !file->validate())
+        return nullptr;
+
+    return file;
+}
+
+///
+/// \brief Load a file written by write() for StepTable::instance()
+/// \return False if the file is unreadable or invalid, or if the step
+///         table is already in use, in which case nothing changes
+///
+/// Must be called before any hand analysis to take effect.
+///
+bool StepTableFile::load(const char *path)
+{
+    std::unique_ptr<StepTableFile> file = read(path);
+    if (file == nullptr)
+        return false;
+
+    StepTableFile *expected = nullptr;
+    if (!sLoaded.compare_exchange_strong(expected, file.get()))
+        return false;
+
+    file.release(); // lives until the process exits
+    return true;
+}
+
+///
+/// \return The loaded file, or null if none
+///
+const StepTableFile *StepTableFile::loaded()
+{
+    StepTableFile *file = sLoaded;
+    return file == sealed() ? nullptr : file;
+}
+
+///
+/// \brief Forbid later loading and get the loaded file if any
+///
+/// Called once when StepTable::instance() is built
+///
+const StepTableFile *StepTableFile::seal()
+{
+    StepTableFile *expected = nullptr;
+    sLoaded.compare_exchange_strong(expected, sealed());
+    return loaded();
+}
+
+StepTableFile::~StepTableFile()
+{
+#ifdef SAKI_STEP_TABLE_MMAP
+    if (mMapped)
+        munmap(const_cast<unsigned char *>(mData), mSize);
+#endif
+}
+
+int StepTableFile::numCt() const
+{
+    return reinterpret_cast<const Header *>(mData)->numCt;
+}
+
+int StepTableFile::honorCt() const
+{
+    return reinterpret_cast<const Header *>(mData)->honorCt;
+}
+
+const StepTable::Works *StepTableFile::nums() const
+{
+    return reinterpret_cast<const StepTable::Works *>(mData + sizeof(Header));
+}
+
+const StepTable::Works *StepTableFile::honors() const
+{
+    return nums() + numCt();
+}
+
+bool StepTableFile::open(const char *path)
+{
+#ifdef SAKI_STEP_TABLE_MMAP
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Header))) {
+        close(fd);
+        return false;
+    }
+
+    void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+        return false;
+
+    mData = static_cast<const unsigned char *>(addr);
+    mSize = st.st_size;
+    mMapped = true;
+    return true;
+#else
+    std::ifstream in(path, std::ios::binary);
+    mBuffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    if (mBuffer.size() < sizeof(Header))
+        return false;
+
+    mData = mBuffer.data();
+    mSize = mBuffer.size();
+    return true;
+#endif
+}
+
+bool StepTableFile::validate() const
+{
+    const Header &header = *reinterpret_cast<const Header *>(mData);
+
+    bool sameFormat = std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0
+        && header.version == VERSION
+        && header.maxSum == StepTable::MAX_SUM
+        && header.numKind == StepTable::NUM_KIND
+        && header.honorKind == StepTable::HONOR_KIND
+        && header.worksSize == sizeof(StepTable::Works);
+    if (!sameFormat)
+        return false;
+
+    size_t payload = sizeof(StepTable::Works) * (size_t(header.numCt) + header.honorCt);
+    if (mSize != sizeof(Header) + payload)
+        return false;
+
+    return checksumOf(mData + sizeof(Header), payload) == header.checksum;
+}
+
+uint32_t StepTableFile::checksumOf(const unsigned char *data, size_t size)
+{
+    uint32_t res = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        res ^= data[i];
+        res *= 16777619u;
+    }
+
+    return res;
+}
+
+
+
+} // namespace saki
@@ -0,0 +1,88 @@
+#ifndef SAKI_STEP_TABLE_FILE_H
+#define SAKI_STEP_TABLE_FILE_H
+
+#include "step_table.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+
+
+namespace saki
+{
+
+
+
+///
+/// \brief Versioned binary file of the step table
+///
+/// Building the step table takes a noticeable time at the first hand
+/// analysis of a process. A host can instead generate the file once
+/// offline by write(), and let every process load() it at start-up.
+/// Where mmap is available the file is mapped read-only, so that all
+/// processes on a machine share one page-cache copy of it.
+///
+/// Layout: a Header followed by the number-suit works and the honor
+/// works, both in the rank order of StepTable, all in native byte order.
+///
+class StepTableFile
+{
+public:
+    static const uint32_t VERSION = 1;
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint8_t maxSum;
+        uint8_t numKind;
+        uint8_t honorKind;
+        uint8_t worksSize;
+        uint32_t numCt;
+        uint32_t honorCt;
+        uint32_t checksum; ///< FNV-1a of the payload
+    };
+
+    static bool write(const char *path);
+    static std::unique_ptr<StepTableFile> read(const char *path);
+    static bool load(const char *path);
+    static const StepTableFile *loaded();
+
+    ~StepTableFile();
+
+    StepTableFile(const StepTableFile &copy) = delete;
+    StepTableFile &operator=(const StepTableFile &assign) = delete;
+
+    int numCt() const;
+    int honorCt() const;
+    const StepTable::Works *nums() const;
+    const StepTable::Works *honors() const;
+
+private:
+    friend class StepTable;
+
+    StepTableFile() = default;
+
+    static const StepTableFile *seal();
+
+    bool open(const char *path);
+    bool validate() const;
+
+    static uint32_t checksumOf(const unsigned char *data, size_t size);
+
+private:
+    const unsigned char *mData = nullptr;
+    size_t mSize = 0;
+    bool mMapped = false;
+    std::vector<unsigned char> mBuffer; ///< Used where mmap is unavailable
+};
+
+
+
+} // namespace saki
+
+
+
+#endif // SAKI_STEP_TABLE_FILE_H
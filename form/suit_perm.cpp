@@ -0,0 +1,83 @@
+#include "suit_perm.h"
+
+#include <cassert>
+
+
+
+namespace saki
+{
+
+
+
+SuitPerm::SuitPerm()
+    : mTo { 0, 1, 2 }
+{
+}
+
+///
+/// \brief Let suit 'from' be mapped to 'to'
+/// \pre Both are number suits, and the result is kept bijective by the caller
+///
+void SuitPerm::set(Suit from, Suit to)
+{
+    assert(static_cast<int>(from) < 3 && static_cast<int>(to) < 3);
+    mTo[static_cast<int>(from)] = static_cast<int>(to);
+}
+
+bool SuitPerm::isIdentity() const
+{
+    return mTo[0] == 0 && mTo[1] == 1 && mTo[2] == 2;
+}
+
+SuitPerm SuitPerm::inverse() const
+{
+    SuitPerm res;
+    for (int s = 0; s < 3; s++)
+        res.mTo[mTo[s]] = s;
+
+    return res;
+}
+
+Suit SuitPerm::operator()(Suit s) const
+{
+    int i = static_cast<int>(s);
+    return i < 3 ? Suit(mTo[i]) : s;
+}
+
+T34 SuitPerm::operator()(T34 t) const
+{
+    return t.isNum() ? T34((*this)(t.suit()), t.val()) : t;
+}
+
+C34 SuitPerm::operator()(const C34 &c) const
+{
+    return C34(c.type(), (*this)(c.head()));
+}
+
+std::bitset<34> SuitPerm::operator()(const std::bitset<34> &ts) const
+{
+    const unsigned long long suitMask = (1ULL << 9) - 1;
+    unsigned long long bits = ts.to_ullong();
+    unsigned long long res = bits & ~((1ULL << 27) - 1); // honors
+
+    for (int s = 0; s < 3; s++)
+        res |= ((bits >> (9 * s)) & suitMask) << (9 * mTo[s]);
+
+    return std::bitset<34>(res);
+}
+
+///
+/// \brief Compose permutations, 'first' applied before this one
+///
+SuitPerm SuitPerm::operator()(const SuitPerm &first) const
+{
+    SuitPerm res;
+    for (int s = 0; s < 3; s++)
+        res.mTo[s] = mTo[first.mTo[s]];
+
+    return res;
+}
+
+
+
+} // namespace saki
@@ -0,0 +1,52 @@
+#ifndef SAKI_SUIT_PERM_H
+#define SAKI_SUIT_PERM_H
+
+#include "../unit/comeld.h"
+
+#include <array>
+#include <bitset>
+
+
+
+namespace saki
+{
+
+
+
+///
+/// \brief A permutation of the three number suits, honors untouched
+///
+/// 4-meld analysis is symmetric under such permutations, so results of
+/// a hand can be computed on a canonical representative and mapped back.
+///
+class SuitPerm
+{
+public:
+    /// \brief Identity permutation
+    SuitPerm();
+
+    SuitPerm(const SuitPerm &copy) = default;
+    SuitPerm &operator=(const SuitPerm &assign) = default;
+
+    void set(Suit from, Suit to);
+
+    bool isIdentity() const;
+    SuitPerm inverse() const;
+
+    Suit operator()(Suit s) const;
+    T34 operator()(T34 t) const;
+    C34 operator()(const C34 &c) const;
+    std::bitset<34> operator()(const std::bitset<34> &ts) const;
+    SuitPerm operator()(const SuitPerm &first) const;
+
+private:
+    std::array<int, 3> mTo;
+};
+
+
+
+} // namespace saki
+
+
+
+#endif // SAKI_SUIT_PERM_H
@@ -1,6 +1,9 @@
 #include "tile_count.h"
+#include "parse_cache.h"
 #include "../util/misc.h"
 
+#include <algorithm>
+
 
 
 namespace saki
@@ -169,7 +172,28 @@ int TileCount::stepGb(int barkCt) const
     return std::min(s4, std::min(s7, s13));
 }
 
+///
+/// \brief Compute 4-meld shanten number by per-suit table lookup
+/// \param barkCt Number of barks
+///
+/// Falls back to step4ByCut() when some suit is out of the table
+///
 int TileCount::step4(int barkCt) const
+{
+    StepTable::Suits suits;
+    if (!lookupSuits(suits))
+        return step4ByCut(barkCt);
+
+    return StepTable::step4(suits, barkCt);
+}
+
+///
+/// \brief Compute 4-meld shanten number by recursive cutting
+/// \param barkCt Number of barks
+///
+/// Reference implementation of step4(), slow but straightforward
+///
+int TileCount::step4ByCut(int barkCt) const
 {
     int maxCut = 4 - barkCt;
     int min = 8;
@@ -247,7 +271,31 @@ bool TileCount::hasEffA(int barkCt, T34 t) const
 
 bool TileCount::hasEffA4(int barkCt, T34 t) const
 {
-    return !dislike4(t) && peekDraw(t, &TileCount::step4, barkCt) < step4(barkCt);
+    if (dislike4(t))
+        return false;
+
+    StepTable::Suits suits;
+    if (!lookupSuits(suits))
+        return hasEffA4ByCut(barkCt, t);
+
+    int curr = StepTable::step4(suits, barkCt);
+
+    T34Delta guard(mutableCounts(), t, 1);
+    (void) guard;
+    int s = StepTable::suitIndex(t);
+    suits[s] = lookupSuit(t);
+    if (suits[s] == nullptr)
+        return step4ByCut(barkCt) < curr;
+
+    return StepTable::step4(suits, barkCt) < curr;
+}
+
+///
+/// \brief Reference implementation of hasEffA4() by recursive cutting
+///
+bool TileCount::hasEffA4ByCut(int barkCt, T34 t) const
+{
+    return !dislike4(t) && peekDraw(t, &TileCount::step4ByCut, barkCt) < step4ByCut(barkCt);
 }
 
 bool TileCount::hasEffA7(T34 t) const
@@ -260,6 +308,47 @@ bool TileCount::hasEffA13(T34 t) const
     return t.isYao() && peekDraw(t, &TileCount::step13) < step13();
 }
 
+///
+/// \brief Get the set of tiles that decrease step4() when drawn
+/// \param barkCt Number of barks
+///
+/// Each candidate re-looks-up only the suit it belongs to,
+/// and is merged with the unchanged other suits merged beforehand
+///
+std::bitset<34> TileCount::effA4Set(int barkCt) const
+{
+    std::bitset<34> res;
+
+    StepTable::Suits suits;
+    if (!lookupSuits(suits)) {
+        for (T34 t : tiles34::ALL34)
+            res[t.id34()] = hasEffA4ByCut(barkCt, t);
+
+        return res;
+    }
+
+    int curr = StepTable::step4(suits, barkCt);
+
+    std::array<StepTable::Merged, 4> others;
+    for (int s = 0; s < 4; s++)
+        others[s] = StepTable::mergeExcept(suits, s);
+
+    for (T34 t : tiles34::ALL34) {
+        if (dislike4(t))
+            continue;
+
+        T34Delta guard(mutableCounts(), t, 1);
+        (void) guard;
+        const StepTable::Works *drawn = lookupSuit(t);
+        int next = drawn == nullptr
+            ? step4ByCut(barkCt)
+            : StepTable::step4(others[StepTable::suitIndex(t)], *drawn, barkCt);
+        res[t.id34()] = next < curr;
+    }
+
+    return res;
+}
+
 ///
 /// \brief List all kind of tiles in this set
 /// \return At most 13 kind of tiles
@@ -351,50 +440,125 @@ Parseds TileCount::parse(int barkCt) const
 /// \param barkCt Number of barks
 /// \return A Parseds object representing all possible explanations
 ///
+/// Results are computed on the canonical() form of this hand,
+/// memoized in the process-wide ParseCache, and mapped back lazily.
+/// A cache hit allocates nothing. A miss allocates the results once,
+/// plus the nodes of the cache entry.
+///
 Parsed4s TileCount::parse4(int barkCt) const
 {
-    std::vector<Parsed4> reses;
+    SuitPerm toOrigin;
+    TileCount canon = canonical(toOrigin);
+
+    ParseCache &cache = ParseCache::instance();
+    ParseCache::Key key = ParseCache::keyOf(canon.mCounts, barkCt);
+    std::optional<Parsed4s> res = cache.find(key);
+    if (!res.has_value()) {
+        res = canon.parse4Uncached(barkCt);
+        cache.insert(key, *res);
+    }
+
+    return toOrigin.isIdentity() ? std::move(*res) : res->permuted(toOrigin);
+}
+
+///
+/// \brief Same as parse4() but always compute
+///
+/// The search itself allocates nothing in steady state: cutting goes
+/// depth-first on a single stack-allocated Heads, and leaves are kept
+/// in per-thread arenas that retain their capacity between calls.
+/// The only allocations are the exact-sized result container and its
+/// shared owner. No bound on the number of results is known, so the
+/// container stays on the heap.
+///
+Parsed4s TileCount::parse4Uncached(int barkCt) const
+{
+    thread_local std::vector<Parsed4::Heads> arena;
+    thread_local std::vector<Parsed4> found;
+    found.clear();
 
     int maxCut = 4 - barkCt;
     int min = 8;
 
     // *INDENT-OFF*
     auto update = [&](bool hasBirdHead, T34 h = T34()) {
-        auto subreses = cutMeldOut(0, maxCut);
-        int comin = (hasBirdHead ? 7 : 8) - Parsed4::workOfHeads(subreses[0]) - 2 * barkCt;
+        Parsed4::Heads heads;
+        if (hasBirdHead)
+            heads.emplaceBack(C34::Type::PAIR, h); // not counted in work
+
+        arena.clear();
+        CutLeaves leaves { arena, -1 };
+        searchMeld(0, maxCut, 0, heads, leaves);
+        int comin = (hasBirdHead ? 7 : 8) - leaves.maxWork - 2 * barkCt;
 
         if (comin <= min) {
             if (comin < min) {
                 min = comin;
-                reses.clear();
+                found.clear();
             }
 
-            if (hasBirdHead)
-                for (Parsed4::Heads &heads : subreses)
-                    heads.emplaceBack(C34::Type::PAIR, h);
-
-            for (Parsed4::Heads &heads : subreses) {
-                Parsed4 parsed(heads, barkCt);
-                if (!util::has(reses, parsed))
-                    reses.emplace_back(parsed);
+            for (const Parsed4::Heads &leaf : arena) {
+                Parsed4 parsed(leaf, barkCt);
+                if (!util::has(found, parsed))
+                    found.emplace_back(parsed);
             }
         }
     };
     // *INDENT-ON*
 
+    // skip cases that cannot reach the min step, known by table lookup
+    const int minStep = step4(barkCt);
+
     // having-birdhead cases
     for (T34 h : tiles34::ALL34) {
         if (ct(h) >= 2) {
             T34Delta guard(mutableCounts(), h, -2);
             (void) guard;
-            update(true, h);
+            if (step4Birdless(barkCt) - 1 == minStep)
+                update(true, h);
         }
     }
 
     // birdhead-less case
-    update(false);
+    if (step4Birdless(barkCt) == minStep)
+        update(false);
 
-    return Parsed4s(std::move(reses));
+    return Parsed4s(Parsed4s::Container(found.begin(), found.end()));
+}
+
+///
+/// \brief Reorder the number suits into a canonical order
+/// \param toOrigin Output, maps the result's suits back to this one's
+///
+/// Hands differing only by a permutation of m/p/s share the same
+/// canonical form, so that caches of 4-meld results need fewer entries.
+/// The order is lexicographically descending by the count vectors.
+///
+TileCount TileCount::canonical(SuitPerm &toOrigin) const
+{
+    std::array<int, 3> order { 0, 1, 2 };
+
+    // *INDENT-OFF*
+    auto greater = [this](int l, int r) {
+        auto lb = mCounts.begin() + 9 * l;
+        auto rb = mCounts.begin() + 9 * r;
+        return std::lexicographical_compare(rb, rb + 9, lb, lb + 9);
+    };
+    // *INDENT-ON*
+
+    // stable insertion sort, as std::stable_sort may allocate a buffer
+    for (int i = 1; i < 3; i++)
+        for (int j = i; j > 0 && greater(order[j], order[j - 1]); j--)
+            std::swap(order[j], order[j - 1]);
+
+    TileCount res(*this);
+    for (int c = 0; c < 3; c++) {
+        std::copy_n(mCounts.begin() + 9 * order[c], 9, res.mCounts.begin() + 9 * c);
+        res.mAka5s[c] = mAka5s[order[c]];
+        toOrigin.set(Suit(c), Suit(order[c]));
+    }
+
+    return res;
 }
 
 Parsed7 TileCount::parse7() const
@@ -429,14 +593,14 @@ Parsed13 TileCount::parse13() const
     return Parsed13(yaos, hasYaoPair);
 }
 
-std::vector<TileCount::Explain4Closed> TileCount::explain4(T34 pick) const
+TileCount::Explain4Closeds TileCount::explain4(T34 pick) const
 {
     // no assertion. the result will be illegal if the input is illegal
 
     T34Delta guard(mutableCounts(), pick, 1);
     (void) guard;
 
-    std::vector<Explain4Closed> res;
+    Explain4Closeds res;
 
     // enumerate for all possible birdheads
     for (int ti = 0; ti < 34; ti++) {
@@ -605,6 +769,46 @@ std::array<int, 34> &TileCount::mutableCounts() const
     return const_cast<std::array<int, 34> &>(mCounts);
 }
 
+///
+/// \brief Look up the step table for all the four suits
+/// \return False if any suit is out of the table
+///
+bool TileCount::lookupSuits(StepTable::Suits &suits) const
+{
+    const StepTable &table = StepTable::instance();
+
+    for (int s = 0; s < 3; s++) {
+        suits[s] = table.num(&mCounts[9 * s]);
+        if (suits[s] == nullptr)
+            return false;
+    }
+
+    suits[3] = table.honor(&mCounts[27]);
+    return suits[3] != nullptr;
+}
+
+///
+/// \brief Look up the step table for the suit of 't'
+/// \return Null if the suit is out of the table
+///
+const StepTable::Works *TileCount::lookupSuit(T34 t) const
+{
+    const StepTable &table = StepTable::instance();
+    return t.isZ() ? table.honor(&mCounts[27]) : table.num(&mCounts[9 * (t.id34() / 9)]);
+}
+
+///
+/// \brief Step-4 of the birdhead-less case, i.e. no pair is counted as bird-head
+///
+int TileCount::step4Birdless(int barkCt) const
+{
+    StepTable::Suits suits;
+    if (!lookupSuits(suits))
+        return 8 - cutMeld(0, 4 - barkCt) - 2 * barkCt;
+
+    return StepTable::step4Birdless(suits, barkCt);
+}
+
 ///
 /// \brief Cut-out meld and submeld from the count and get the max work-delta
 /// \param id34 Index of the beginning tile
@@ -648,38 +852,32 @@ int TileCount::cutMeld(int id34, int maxCut) const
     return maxWork;
 }
 
-std::vector<Parsed4::Heads> TileCount::cutMeldOut(int id34, int maxCut) const
+///
+/// \brief Depth-first version of cutMeld() collecting the max-work leaves
+/// \param work Work of the melds cut so far
+/// \param heads Comelds cut so far, restored before return
+///
+/// Keeping only the max-work leaves over the whole search gives the
+/// same leaves as keeping the max-work children at every level.
+///
+void TileCount::searchMeld(int id34, int maxCut, int work, Parsed4::Heads &heads,
+                           CutLeaves &leaves) const
 {
-    std::vector<Parsed4::Heads> reses;
-    NonEmptyGuard guard(reses);
-    (void) guard;
-
     while (id34 < 34 && mCounts[id34] == 0)
         id34++;
 
-    if (id34 >= 34)
-        return cutSubmeldOut(0, maxCut);
+    if (id34 >= 34) {
+        searchSubmeld(0, maxCut, work, heads, leaves);
+        return;
+    }
 
     const T34 t(id34);
-    int maxWork = 0;
 
     // *INDENT-OFF*
-    auto updateWork = [&](C34::Type type, bool cut) {
-        auto subreses = cutMeldOut(id34 + !cut, maxCut - cut);
-        int work = (cut ? 2 : 0) + Parsed4::workOfHeads(subreses[0]);
-
-        if (work >= maxWork) {
-            if (work > maxWork) {
-                maxWork = work;
-                reses.clear();
-            }
-
-            if (cut)
-                for (Parsed4::Heads &heads : subreses)
-                    heads.emplaceBack(type, t);
-
-            reses.insert(reses.end(), subreses.begin(), subreses.end());
-        }
+    auto cut = [&](C34::Type type) {
+        heads.emplaceBack(type, t);
+        searchMeld(id34, maxCut - 1, work + 2, heads, leaves);
+        heads.popBack();
     };
     // *INDENT-ON*
 
@@ -687,7 +885,7 @@ std::vector<Parsed4::Heads> TileCount::cutMeldOut(int id34, int maxCut) const
         if (ct(t) >= 3) {
             T34Delta guard(mutableCounts(), t, -3);
             (void) guard;
-            updateWork(C34::Type::TRI, true);
+            cut(C34::Type::TRI);
         }
 
         if (t.isNum() && t.val() <= 7 && ct(t.next()) > 0 && ct(t.nnext()) > 0) {
@@ -695,13 +893,11 @@ std::vector<Parsed4::Heads> TileCount::cutMeldOut(int id34, int maxCut) const
             T34Delta guard2(mutableCounts(), t.next(), -1);
             T34Delta guard3(mutableCounts(), t.nnext(), -1);
             (void) guard1; (void) guard2; (void) guard3;
-            updateWork(C34::Type::SEQ, true);
+            cut(C34::Type::SEQ);
         }
     }
 
-    updateWork(C34::Type::FREE, false);
-
-    return reses;
+    searchMeld(id34 + 1, maxCut, work, heads, leaves);
 }
 
 ///
@@ -757,37 +953,36 @@ int TileCount::cutSubmeld(int id34, int maxCut) const
     return maxWork;
 }
 
-std::vector<Parsed4::Heads> TileCount::cutSubmeldOut(int id34, int maxCut) const
+///
+/// \brief Depth-first version of cutSubmeld() collecting the max-work leaves
+/// \param work Work of the melds and submelds cut so far
+/// \param heads Comelds cut so far, restored before return
+///
+void TileCount::searchSubmeld(int id34, int maxCut, int work, Parsed4::Heads &heads,
+                              CutLeaves &leaves) const
 {
-    std::vector<Parsed4::Heads> reses;
-    NonEmptyGuard guard(reses);
-    (void) guard;
-
     while (id34 < 34 && mCounts[id34] == 0)
         id34++;
 
-    if (id34 >= 34)
-        return reses;
+    if (id34 >= 34) {
+        if (work > leaves.maxWork) {
+            leaves.maxWork = work;
+            leaves.arena.clear();
+        }
 
-    int maxWork = 0;
-    const T34 t(id34);
+        if (work == leaves.maxWork)
+            leaves.arena.push_back(heads);
 
-    // *INDENT-OFF*
-    auto updateWork = [&](C34::Type type, bool cut) {
-        auto subreses = cutSubmeldOut(id34 + !cut, maxCut - cut);
-        int work = cut + Parsed4::workOfHeads(subreses[0]);
-
-        if (work >= maxWork) {
-            if (work > maxWork) {
-                maxWork = work;
-                reses.clear();
-            }
+        return;
+    }
 
-            for (Parsed4::Heads &heads : subreses)
-                heads.emplaceBack(type, t);
+    const T34 t(id34);
 
-            reses.insert(reses.end(), subreses.begin(), subreses.end());
-        }
+    // *INDENT-OFF*
+    auto cut = [&](C34::Type type) {
+        heads.emplaceBack(type, t);
+        searchSubmeld(id34, maxCut - 1, work + 1, heads, leaves);
+        heads.popBack();
     };
     // *INDENT-ON*
 
@@ -795,27 +990,28 @@ std::vector<Parsed4::Heads> TileCount::cutSubmeldOut(int id34, int maxCut) const
         if (ct(t) >= 2) {
             T34Delta guard(mutableCounts(), t, -2);
             (void) guard;
-            updateWork(C34::Type::PAIR, true);
+            cut(C34::Type::PAIR);
         }
 
         if (t.isNum() && t.val() <= 8 && ct(t.next()) > 0) {
             T34Delta guard1(mutableCounts(), t, -1);
             T34Delta guard2(mutableCounts(), t.next(), -1);
             (void) guard1; (void) guard2;
-            updateWork(t.val() == 1 || t.val() == 8 ? C34::Type::SIDE : C34::Type::BIFACE, true);
+            cut(t.val() == 1 || t.val() == 8 ? C34::Type::SIDE : C34::Type::BIFACE);
         }
 
         if (t.isNum() && t.val() <= 7 && ct(t.nnext()) > 0) {
-            T34Delta guard1(mutableCounts(), T34(id34), -1);
-            T34Delta guard2(mutableCounts(), T34(id34 + 2), -1);
+            T34Delta guard1(mutableCounts(), t, -1);
+            T34Delta guard2(mutableCounts(), t.nnext(), -1);
             (void) guard1; (void) guard2;
-            updateWork(C34::Type::CLAMP, true);
+            cut(C34::Type::CLAMP);
         }
     }
 
-    updateWork(C34::Type::FREE, false);
-
-    return reses;
+    // remaining copies of 't' all float, recorded once
+    heads.emplaceBack(C34::Type::FREE, t);
+    searchSubmeld(id34 + 1, maxCut, work, heads, leaves);
+    heads.popBack();
 }
 
 bool TileCount::decomposeBirdless4(Explain4Closed &exp,
@@ -829,6 +1025,9 @@ bool TileCount::decomposeBirdless4(Explain4Closed &exp,
             return false;
 
         if (remain >= 3) {
+            if (exp.triplets.full())
+                return false; // more than 4 melds never complete
+
             exp.triplets.push_back(T34(tj));
             remain -= 3;
         }
@@ -837,6 +1036,9 @@ bool TileCount::decomposeBirdless4(Explain4Closed &exp,
             if (T34(tj).isZ() || T34(tj).val() > 7)
                 return false; // must be a floating tile
 
+            if (exp.sequences.size() + remain > 4)
+                return false; // more than 4 melds never complete
+
             borrows[1] += remain;
             borrows[2] += remain;
             while (remain-- > 0)
@@ -869,17 +1071,4 @@ TileCount::T34Delta::~T34Delta()
 
 
 
-TileCount::NonEmptyGuard::NonEmptyGuard(std::vector<Parsed4::Heads> &p)
-    : mParseds(p)
-{
-}
-
-TileCount::NonEmptyGuard::~NonEmptyGuard()
-{
-    if (mParseds.empty())
-        mParseds.emplace_back();
-}
-
-
-
 } // namespace saki
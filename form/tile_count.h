@@ -2,6 +2,7 @@
 #define SAKI_TILECOUNT_H
 
 #include "parsed.h"
+#include "step_table.h"
 
 #include <vector>
 #include <initializer_list>
@@ -23,10 +24,16 @@ public:
     {
         explicit Explain4Closed(T34 p) : pair(p) {}
         T34 pair;
-        std::vector<T34> triplets;
-        std::vector<T34> sequences;
+        util::Stactor<T34, 4> triplets;
+        util::Stactor<T34, 4> sequences;
     };
 
+    ///
+    /// At most 3 per bird-head, and no more than 4 in total were found.
+    /// testExplain4() checks the bound over all one-suit complete hands
+    ///
+    using Explain4Closeds = util::Stactor<Explain4Closed, 8>;
+
     TileCount();
     explicit TileCount(AkadoraCount fillMode);
     explicit TileCount(std::initializer_list<T37> t37s);
@@ -62,15 +69,19 @@ public:
     int step(int barkCt) const;
     int stepGb(int barkCt) const;
     int step4(int barkCt) const;
+    int step4ByCut(int barkCt) const;
     int step7() const;
     int step7Gb() const;
     int step13() const;
 
     bool hasEffA(int barkCt, T34 t) const;
     bool hasEffA4(int barkCt, T34 t) const;
+    bool hasEffA4ByCut(int barkCt, T34 t) const;
     bool hasEffA7(T34 t) const;
     bool hasEffA13(T34 t) const;
 
+    std::bitset<34> effA4Set(int barkCt) const;
+
     util::Stactor<T34, 13> t34s13() const;
     util::Stactor<T37, 13> t37s13(bool allowDup = false) const;
 
@@ -78,10 +89,13 @@ public:
 
     Parseds parse(int barkCt) const;
     Parsed4s parse4(int barkCt) const;
+    Parsed4s parse4Uncached(int barkCt) const;
+
+    TileCount canonical(SuitPerm &toOrigin) const;
     Parsed7 parse7() const;
     Parsed13 parse13() const;
 
-    std::vector<Explain4Closed> explain4(T34 pick) const;
+    Explain4Closeds explain4(T34 pick) const;
     bool onlyInTriplet(T34 pick, int barkCt) const;
 
     int sum(const std::vector<T34> &ts) const;
@@ -118,21 +132,23 @@ private:
         int mDelta;
     };
 
-    class NonEmptyGuard
+    ///
+    /// \brief Max-work leaves of searchMeld() and searchSubmeld()
+    ///
+    struct CutLeaves
     {
-    public:
-        explicit NonEmptyGuard(std::vector<Parsed4::Heads> &p);
-        ~NonEmptyGuard();
-
-    private:
-        std::vector<Parsed4::Heads> &mParseds;
+        std::vector<Parsed4::Heads> &arena; ///< Reused, keeps its capacity
+        int maxWork;
     };
 
     std::array<int, 34> &mutableCounts() const;
+    bool lookupSuits(StepTable::Suits &suits) const;
+    const StepTable::Works *lookupSuit(T34 t) const;
+    int step4Birdless(int barkCt) const;
     int cutMeld(int i, int maxCut) const;
-    std::vector<Parsed4::Heads> cutMeldOut(int i, int maxCut) const;
+    void searchMeld(int i, int maxCut, int work, Parsed4::Heads &heads, CutLeaves &leaves) const;
     int cutSubmeld(int i, int maxCut) const;
-    std::vector<Parsed4::Heads> cutSubmeldOut(int i, int maxCut) const;
+    void searchSubmeld(int i, int maxCut, int work, Parsed4::Heads &heads, CutLeaves &leaves) const;
     bool decomposeBirdless4(Explain4Closed &exp, const std::array<int, 34> &mCounts) const;
 
 private:
@@ -1,5 +1,7 @@
 #include "tile_count_list.h"
 
+#include <algorithm>
+
 
 
 namespace saki
@@ -17,13 +19,30 @@ TileCountList::TileCountList(int sum, T34 min, T34 max)
     : mSum(sum)
     , mMinTile(min)
     , mMaxTile(max)
+    , mBegin(0)
 {
     assert(0 <= sum && sum <= (max.id34() - min.id34() + 1) * 4);
+
+    const int kindCt = max.id34() - min.id34() + 1;
+    mCounts.assign(kindCt + 1, std::vector<uint64_t>(sum + 1, 0));
+    mCounts[0][0] = 1;
+    for (int k = 1; k <= kindCt; k++) {
+        for (int s = 0; s <= sum; s++) {
+            for (int x = 0; x <= std::min(4, s); x++) {
+                // saturate, too many to be walked anyways
+                uint64_t add = mCounts[k - 1][s - x];
+                mCounts[k][s] = add > UINT64_MAX - mCounts[k][s] ? UINT64_MAX : mCounts[k][s] + add;
+            }
+        }
+    }
+
+    mSize = countOf(kindCt, sum);
+    assert(mSize < UINT64_MAX);
 }
 
 TileCountList::Iter TileCountList::begin()
 {
-    return Iter(mSum, mMinTile, mMaxTile);
+    return Iter(mSum, mMinTile, mMaxTile, mSize > 0 ? at(0) : TileCount(), mSize);
 }
 
 TileCountList::End TileCountList::end()
@@ -31,15 +50,108 @@ TileCountList::End TileCountList::end()
     return {};
 }
 
-TileCountList::Iter::Iter(int sum, T34 min, T34 max)
+///
+/// \brief Number of items in the list
+///
+uint64_t TileCountList::size() const
+{
+    return mSize;
+}
+
+///
+/// \brief Get the item of the given rank in this list without walking
+///
+TileCount TileCountList::at(uint64_t rank) const
+{
+    assert(rank < mSize);
+    rank += mBegin;
+
+    TileCount res;
+    int remain = mSum;
+    for (int ti = mMinTile.id34(); ti <= mMaxTile.id34(); ti++) {
+        int rest = mMaxTile.id34() - ti;
+        for (int x = 0; x <= std::min(4, remain); x++) {
+            uint64_t ct = countOf(rest, remain - x);
+            if (rank < ct) {
+                res.inc(T37(ti), x);
+                remain -= x;
+                break;
+            }
+
+            rank -= ct;
+        }
+    }
+
+    assert(remain == 0);
+    return res;
+}
+
+///
+/// \brief Sub-list of items ranked in [begin, end) of this list
+///
+TileCountList TileCountList::slice(uint64_t begin, uint64_t end) const
+{
+    assert(begin <= end && end <= mSize);
+
+    TileCountList res(*this);
+    res.mBegin = mBegin + begin;
+    res.mSize = end - begin;
+    return res;
+}
+
+///
+/// \brief Cut the list into 'partCt' contiguous slices of almost equal sizes
+///
+std::vector<TileCountList> TileCountList::split(int partCt) const
+{
+    assert(partCt > 0);
+
+    std::vector<TileCountList> res;
+    res.reserve(partCt);
+    for (int i = 0; i < partCt; i++)
+        res.push_back(slice(mSize * i / partCt, mSize * (i + 1) / partCt));
+
+    return res;
+}
+
+///
+/// \brief Call 'f' on every item using all threads of 'pool'
+///
+/// The list is cut into several slices per thread so that slow items
+/// gathering in a range do not leave other threads idle.
+/// 'f' is called concurrently and in no particular order.
+///
+void TileCountList::forEach(util::ThreadPool &pool,
+                            const std::function<void(const TileCount &)> &f) const
+{
+    std::vector<TileCountList> parts = split(8 * pool.threadCt());
+
+    // *INDENT-OFF*
+    pool.run(parts.size(), [&parts, &f](int i) {
+        for (const TileCount &tc : parts[i])
+            f(tc);
+    });
+    // *INDENT-ON*
+}
+
+uint64_t TileCountList::countOf(int kindCt, int sum) const
+{
+    return sum < 0 ? 0 : mCounts[kindCt][sum];
+}
+
+///
+/// \param first The first item
+/// \param size Number of items to walk, the first one included
+///
+TileCountList::Iter::Iter(int sum, T34 min, T34 max, const TileCount &first, uint64_t size)
     : mSum(sum)
     , mMinTile(min)
     , mMaxTile(max)
+    , mCount(first)
+    , mLeft(size)
+    , mEnd(size == 0)
 {
     assert(0 <= sum && sum <= (max.id34() - min.id34() + 1) * 4);
-
-    setMin(min.id34(), sum);
-    mEnd = isMax(min.id34(), mSum);
 }
 
 const TileCount &TileCountList::Iter::operator*() noexcept
@@ -52,6 +164,11 @@ TileCountList::Iter &TileCountList::Iter::operator++() noexcept
     if (mEnd)
         return *this;
 
+    if (--mLeft == 0) {
+        mEnd = true;
+        return *this;
+    }
+
     int beginOfMax = mMinTile.id34();
     int workOfMax = mSum;
 
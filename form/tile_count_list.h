@@ -2,6 +2,11 @@
 #define SAKI_TILE_COUNT_LIST_H
 
 #include "tile_count.h"
+#include "../util/thread_pool.h"
+
+#include <functional>
+#include <vector>
+#include <cstdint>
 
 
 
@@ -14,6 +19,10 @@ namespace saki
 /// \brief An iterable virtual list of all tile-counts whose
 ///        containing tiles sum up to a given number
 ///
+/// Items are in lexicographical order of the counts from the min tile
+/// to the max tile. A list can be sliced into contiguous sub-lists by
+/// rank without walking the items before, for parallel enumeration.
+///
 class TileCountList
 {
 public:
@@ -22,7 +31,7 @@ public:
     class Iter
     {
     public:
-        explicit Iter(int sum, T34 min, T34 max);
+        explicit Iter(int sum, T34 min, T34 max, const TileCount &first, uint64_t size);
 
         // std input iterator traits
         using iterator_category = std::input_iterator_tag;
@@ -45,6 +54,7 @@ public:
         T34 mMinTile;
         T34 mMaxTile;
         TileCount mCount;
+        uint64_t mLeft; ///< Number of items left, the current one included
         bool mEnd = false;
     };
 
@@ -53,10 +63,23 @@ public:
     Iter begin();
     End end();
 
+    uint64_t size() const;
+    TileCount at(uint64_t rank) const;
+    TileCountList slice(uint64_t begin, uint64_t end) const;
+    std::vector<TileCountList> split(int partCt) const;
+
+    void forEach(util::ThreadPool &pool, const std::function<void(const TileCount &)> &f) const;
+
+private:
+    uint64_t countOf(int kindCt, int sum) const;
+
 private:
     int mSum;
     T34 mMinTile;
     T34 mMaxTile;
+    uint64_t mBegin; ///< Rank of the first item in the whole list
+    uint64_t mSize;
+    std::vector<std::vector<uint64_t>> mCounts; ///< Number of vectors by [kind count][sum]
 };
 
 
@@ -0,0 +1,167 @@
+#include "wait_table.h"
+
+#include <algorithm>
+
+
+
+namespace saki
+{
+
+
+
+///
+/// \param ready A ready hand without a drawn tile
+/// \param ctx Context shared by ron and tsumo, as given to Form
+///
+/// Winning tiles are the effective tiles of 'ready', in id34-order,
+/// each picked as a non-red tile.
+///
+WaitTable::WaitTable(const Hand &ready, const FormCtx &ctx, const Rule &rule,
+                     const util::Stactor<T37, 5> &drids, const util::Stactor<T37, 5> &urids)
+    : mReady(ready)
+    , mCtx(ctx)
+    , mRule(rule)
+    , mDrids(drids)
+    , mUrids(urids)
+{
+    assert(ready.ready() && !ready.hasDrawn());
+
+    util::Stactor<T34, 34> effA = ready.effA();
+    mWaits.reserve(effA.size());
+
+    for (T34 t : effA) {
+        T37 pick(t.id34());
+
+        // same order as the Form constructors
+        Form::Type type;
+        if (ready.peekPickStep13(pick) == -1) {
+            type = Form::Type::F13;
+        } else if (ready.peekPickStep4(pick) == -1) {
+            type = Form::Type::F4;
+        } else {
+            assert(ready.peekPickStep7(pick) == -1);
+            type = Form::Type::F7;
+        }
+
+        mWaits.push_back(Wait { t, type, std::nullopt, std::nullopt, std::nullopt, std::nullopt });
+    }
+}
+
+int WaitTable::size() const
+{
+    return mWaits.size();
+}
+
+T34 WaitTable::pick(int i) const
+{
+    return mWaits[i].pick;
+}
+
+///
+/// \return Index of 'pick', or -1 if it is not a winning tile
+///
+int WaitTable::find(T34 pick) const
+{
+    // *INDENT-OFF*
+    auto it = std::find_if(mWaits.begin(), mWaits.end(), [pick](const Wait &w) {
+        return w.pick == pick;
+    });
+    // *INDENT-ON*
+
+    return it == mWaits.end() ? -1 : it - mWaits.begin();
+}
+
+const Form &WaitTable::ron(int i) const
+{
+    const Wait &wait = mWaits[i];
+    if (!wait.ron.has_value())
+        wait.ron.emplace(makeForm(wait, true));
+
+    return *wait.ron;
+}
+
+const Form &WaitTable::tsumo(int i) const
+{
+    const Wait &wait = mWaits[i];
+    if (!wait.tsumo.has_value())
+        wait.tsumo.emplace(makeForm(wait, false));
+
+    return *wait.tsumo;
+}
+
+///
+/// \brief Same as ron(i).hasYaku(), usually without building the form
+///
+bool WaitTable::hasRonYaku(int i) const
+{
+    const Wait &wait = mWaits[i];
+    if (wait.ronYaku.has_value())
+        return *wait.ronYaku;
+
+    if (wait.ron.has_value()) {
+        wait.ronYaku = wait.ron->hasYaku();
+        return *wait.ronYaku;
+    }
+
+    if (wait.type != Form::Type::F4) {
+        wait.ronYaku = true; // kokushi is yakuman, chiitoitsu is a yaku
+        return true;
+    }
+
+    switch (Form(true, mCtx).guessYaku4(mCtx, mRule, mReady, T37(wait.pick.id34()))) {
+    case Form::YakuGuess::NO:
+        wait.ronYaku = false;
+        break;
+    case Form::YakuGuess::YES:
+        wait.ronYaku = true;
+        break;
+    default:
+        wait.ronYaku = ron(i).hasYaku();
+        break;
+    }
+
+    return *wait.ronYaku;
+}
+
+///
+/// \brief Max gain of ron forms with yakus, 0 if none
+///
+int WaitTable::maxRonGain() const
+{
+    int res = 0;
+    for (int i = 0; i < size(); i++)
+        if (hasRonYaku(i))
+            res = std::max(res, ron(i).gain());
+
+    return res;
+}
+
+///
+/// \brief Max gain of tsumo forms with yakus, 0 if none
+///
+int WaitTable::maxTsumoGain() const
+{
+    int res = 0;
+    for (int i = 0; i < size(); i++)
+        if (tsumo(i).hasYaku())
+            res = std::max(res, tsumo(i).gain());
+
+    return res;
+}
+
+Form WaitTable::makeForm(const Wait &wait, bool ron) const
+{
+    T37 pick(wait.pick.id34());
+    if (!wait.expCloseds.has_value()) {
+        if (wait.type == Form::Type::F4)
+            wait.expCloseds = mReady.closed().explain4(pick);
+        else
+            wait.expCloseds.emplace();
+    }
+
+    return Form(mReady, pick, ron, wait.type, *wait.expCloseds, mCtx, mRule, mDrids, mUrids);
+}
+
+
+
+} // namespace saki
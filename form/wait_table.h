@@ -0,0 +1,75 @@
+#ifndef SAKI_WAIT_TABLE_H
+#define SAKI_WAIT_TABLE_H
+
+#include "form.h"
+
+#include <optional>
+
+
+
+namespace saki
+{
+
+
+
+///
+/// \brief Every winning tile of a ready hand with its ron and tsumo forms
+///
+/// The winning type of each winning tile is computed once. Its closed
+/// decompositions are computed at the first form needing them, and
+/// shared by its ron and tsumo forms. Forms are built at their first
+/// query, and hasRonYaku() skips scoring if it can, so riichi and
+/// damaten evaluations only pay for the forms they look at.
+///
+/// Holds the hand and the rule by reference, both must outlive it.
+///
+class WaitTable
+{
+public:
+    explicit WaitTable(const Hand &ready, const FormCtx &ctx, const Rule &rule,
+                       const util::Stactor<T37, 5> &drids = util::Stactor<T37, 5>(),
+                       const util::Stactor<T37, 5> &urids = util::Stactor<T37, 5>());
+
+    WaitTable(const WaitTable &copy) = delete;
+    WaitTable &operator=(const WaitTable &assign) = delete;
+
+    int size() const;
+    T34 pick(int i) const;
+    int find(T34 pick) const;
+
+    const Form &ron(int i) const;
+    const Form &tsumo(int i) const;
+    bool hasRonYaku(int i) const;
+
+    int maxRonGain() const;
+    int maxTsumoGain() const;
+
+private:
+    struct Wait
+    {
+        T34 pick;
+        Form::Type type;
+        mutable std::optional<TileCount::Explain4Closeds> expCloseds;
+        mutable std::optional<bool> ronYaku;
+        mutable std::optional<Form> ron;
+        mutable std::optional<Form> tsumo;
+    };
+
+    Form makeForm(const Wait &wait, bool ron) const;
+
+private:
+    const Hand &mReady;
+    const FormCtx mCtx;
+    const Rule &mRule;
+    const util::Stactor<T37, 5> mDrids;
+    const util::Stactor<T37, 5> mUrids;
+    std::vector<Wait> mWaits;
+};
+
+
+
+} // namespace saki
+
+
+
+#endif // SAKI_WAIT_TABLE_H
@@ -74,7 +74,7 @@ void Uta::power3sk(const Hand &hand, const River &river, Mount &mount)
     };
     // *INDENT-ON*
 
-    auto needs = std::min_element(parseds.begin(), parseds.end(), comp)->claim3sk();
+    auto needs = (*std::min_element(parseds.begin(), parseds.end(), comp)).claim3sk();
     for (T34 t : needs)
         if (util::none(river, [t](const T37 &r) { return t == r; }))
             mount.lightA(t, 500);
@@ -0,0 +1,97 @@
+#include "agari_cache.h"
+#include "../form/lazy_form.h"
+
+#include <cassert>
+
+
+
+namespace saki
+{
+
+
+
+///
+/// \brief Called after the closed tiles or the barks changed
+///
+void AgariCache::invalidate()
+{
+    mValid = false;
+}
+
+///
+/// \brief Get the tiles that turn the 13 closed-or-barked tiles into an agari
+/// \param hand The hand, the drawn tile, if any, is ignored
+/// \return Empty if the hand is not a tenpai
+///
+const std::bitset<34> &AgariCache::agari(const Hand &hand)
+{
+    if (mValid)
+        return mAgari;
+
+    int barkCt = static_cast<int>(hand.barks().size());
+    const TileCount &closed = hand.closed();
+    mAgari.reset();
+    if (closed.step(barkCt) == 0)
+        mAgari = closed.parse(barkCt).effASet();
+
+    mRonKnown.reset();
+    mTsumoKnown.reset();
+    mValid = true;
+    return mAgari;
+}
+
+///
+/// \brief Same as full.canTsumo(ctx, rule)
+///
+bool AgariCache::canTsumo(const Hand &full, const FormCtx &ctx, const Rule &rule)
+{
+    assert(full.hasDrawn());
+
+    T34 t = full.drawn();
+    if (!agari(full).test(t.id34()))
+        return false;
+
+    syncCtx(ctx);
+    if (!mTsumoKnown.test(t.id34())) {
+        mTsumoYaku.set(t.id34(), LazyForm(full, ctx, rule).hasYaku());
+        mTsumoKnown.set(t.id34());
+    }
+
+    return mTsumoYaku.test(t.id34());
+}
+
+///
+/// \brief Same as ready.canRon(t, ctx, rule, doujun)
+///
+bool AgariCache::canRon(const Hand &ready, T34 t, const FormCtx &ctx, const Rule &rule,
+                        bool &doujun)
+{
+    assert(!ready.hasDrawn());
+
+    if (!agari(ready).test(t.id34()))
+        return false;
+
+    syncCtx(ctx);
+    if (!mRonKnown.test(t.id34())) {
+        T37 pick(t.id34()); // whether aka5 does not affect ronnablity
+        mRonYaku.set(t.id34(), LazyForm(ready, pick, ctx, rule).hasYaku());
+        mRonKnown.set(t.id34());
+    }
+
+    bool yaku = mRonYaku.test(t.id34());
+    doujun = !yaku;
+    return yaku;
+}
+
+void AgariCache::syncCtx(const FormCtx &ctx)
+{
+    if (ctx != mCtx) {
+        mCtx = ctx;
+        mRonKnown.reset();
+        mTsumoKnown.reset();
+    }
+}
+
+
+
+} // namespace saki
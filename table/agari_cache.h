@@ -0,0 +1,62 @@
+#ifndef SAKI_AGARI_CACHE_H
+#define SAKI_AGARI_CACHE_H
+
+#include "../form/hand.h"
+#include "../form/form_ctx.h"
+#include "../form/rule.h"
+
+#include <bitset>
+
+
+
+namespace saki
+{
+
+
+
+///
+/// \brief Per-player memo of which tiles complete the hand, and with yaku
+///
+/// The agari set depends only on the closed tiles and the barks,
+/// so it survives draws and spin-outs and is dropped by invalidate()
+/// whenever the Table changes the closed part or the barks.
+/// The yaku flags also depend on the FormCtx, and are dropped
+/// whenever a query comes with a different one (riichi, ippatsu,
+/// kan, haitei, ...). Rule is fixed through the Table's lifetime.
+///
+/// Furiten is not considered here, the Table still checks it.
+///
+class AgariCache
+{
+public:
+    AgariCache() = default;
+    AgariCache(const AgariCache &copy) = default;
+    AgariCache &operator=(const AgariCache &assign) = default;
+    ~AgariCache() = default;
+
+    void invalidate();
+
+    const std::bitset<34> &agari(const Hand &hand);
+    bool canTsumo(const Hand &full, const FormCtx &ctx, const Rule &rule);
+    bool canRon(const Hand &ready, T34 t, const FormCtx &ctx, const Rule &rule, bool &doujun);
+
+private:
+    void syncCtx(const FormCtx &ctx);
+
+private:
+    bool mValid = false;
+    std::bitset<34> mAgari; ///< Tiles completing the closed part
+    FormCtx mCtx;
+    std::bitset<34> mRonKnown;
+    std::bitset<34> mRonYaku;
+    std::bitset<34> mTsumoKnown;
+    std::bitset<34> mTsumoYaku;
+};
+
+
+
+} // namespace saki
+
+
+
+#endif // SAKI_AGARI_CACHE_H
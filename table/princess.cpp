@@ -190,7 +190,7 @@ util::Stactor<int, 34> Princess::permutation(int size)
     for (int i = 0; i < size; i++)
         res.pushBack(i);
 
-    std::shuffle(res.begin(), res.end(), mRand.getUrbg());
+    std::shuffle(res.begin(), res.end(), mRand);
     return res;
 }
 
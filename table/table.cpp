@@ -44,6 +44,9 @@ Table::Table(InitConfig config, std::vector<TableObserver *> obs, const TableEnv
 
     setupObservers(obs);
 
+    if (config.seed != 0)
+        mRand.set(config.seed);
+
     // to choose real init dealer
     mChoicess[mInitDealer.index()].setDice();
 }
@@ -135,6 +138,14 @@ std::unique_ptr<TableView> Table::getView(Who who) const
     return std::make_unique<TableViewReal>(*this, who);
 }
 
+///
+/// \brief Same as getView() but by value, for drivers asking every action
+///
+TableViewReal Table::getRealView(Who who) const
+{
+    return TableViewReal(*this, who);
+}
+
 const Furiten &Table::getFuriten(Who who) const
 {
     return mFuritens[who.index()];
@@ -160,31 +171,12 @@ int Table::getExtraRound() const
     return mExtraRound;
 }
 
-TileCount Table::visibleRemain(Who who) const
+///
+/// \brief Tiles not seen by 'who', maintained along with the table
+///
+const TileCount &Table::visibleRemain(Who who) const
 {
-    TileCount res(mRule.akadora);
-
-    for (int w = 0; w < 4; w++) {
-        for (const T37 &t : mRivers[w])
-            res.inc(t, -1);
-
-        for (const M37 &m : mHands[w].barks()) {
-            const auto &ts = m.tiles();
-            for (int i = 0; i < static_cast<int>(ts.size()); i++)
-                if (i != m.layIndex()) // exclude picked tiles (counted in river)
-                    res.inc(ts[i], -1);
-        }
-    }
-
-    res -= mHands[who.index()].closed();
-
-    if (mHands[who.index()].hasDrawn())
-        res.inc(mHands[who.index()].drawn(), -1);
-
-    for (const T37 &t : mMount.getDrids())
-        res.inc(t, -1);
-
-    return res;
+    return mVisibleRemains[who.index()];
 }
 
 int Table::riverRemain(T34 t) const
@@ -662,6 +654,10 @@ void Table::rollDice()
 void Table::deal()
 {
     mHands = Princess(*this, mRand, mMount, mGirls).dealAndFlip();
+    for (auto &a : mAgaris)
+        a.invalidate();
+
+    resetVisibleRemains();
 
     TableEvent event = TableEvent::Dealt {};
     for (auto ob : mObservers)
@@ -680,6 +676,7 @@ void Table::flipKandoraIndic()
         g->onFlipKandoraIndic(*this, mMount);
 
     mMount.flipIndic(mRand);
+    exposeTile(Who(), mMount.getDrids().back());
     notifyFlipped();
 }
 
@@ -693,6 +690,60 @@ void Table::notifyFlipped()
         ob->onTableEvent(*this, event);
 }
 
+///
+/// \brief Compute visible remaining tiles of every seat from scratch
+///
+void Table::resetVisibleRemains()
+{
+    TileCount common(mRule.akadora);
+
+    for (int w = 0; w < 4; w++) {
+        for (const T37 &t : mRivers[w])
+            common.inc(t, -1);
+
+        for (const M37 &m : mHands[w].barks()) {
+            const auto &ts = m.tiles();
+            for (int i = 0; i < static_cast<int>(ts.size()); i++)
+                if (i != m.layIndex()) // exclude picked tiles (counted in river)
+                    common.inc(ts[i], -1);
+        }
+    }
+
+    for (const T37 &t : mMount.getDrids())
+        common.inc(t, -1);
+
+    for (int w = 0; w < 4; w++) {
+        mVisibleRemains[w] = common;
+        mVisibleRemains[w] -= mHands[w].closed();
+        if (mHands[w].hasDrawn())
+            mVisibleRemains[w].inc(mHands[w].drawn(), -1);
+    }
+}
+
+///
+/// \brief Update visible remaining tiles when 't' becomes public
+/// \param owner The player who already knows 't', or nobody
+///
+void Table::exposeTile(Who owner, const T37 &t)
+{
+    for (int w = 0; w < 4; w++)
+        if (Who(w) != owner)
+            mVisibleRemains[w].inc(t, -1);
+}
+
+///
+/// \brief Expose the tiles of a new or extended bark from its owner's hand
+///
+/// The picked tile is already public as it stays in the river
+///
+void Table::exposeBark(Who who, const M37 &bark)
+{
+    const auto &ts = bark.tiles();
+    for (int i = 0; i < static_cast<int>(ts.size()); i++)
+        if (i != bark.layIndex())
+            exposeTile(who, ts[i]);
+}
+
 ///
 /// \brief Draw a tile from the mountain,
 ///        and triggers ryuukyoku if the mountain is empty
@@ -714,11 +765,12 @@ void Table::tryDraw(Who who)
 
         T37 tile = mMount.pop(mRand, rinshan);
         mHands[w].draw(tile);
+        mVisibleRemains[w].inc(tile, -1);
 
         Choices::ModeDrawn mode;
 
         mode.swapOut = !riichiEstablished(who);
-        mode.tsumo = mHands[w].canTsumo(getFormCtx(who), mRule);
+        mode.tsumo = mAgaris[w].canTsumo(mHands[w], getFormCtx(who), mRule);
         mode.kskp = noBarkYet() && mRivers[w].empty() && mHands[w].nine9();
 
         if (mMount.remainPii() >= 4
@@ -770,6 +822,8 @@ void Table::swapOut(Who who, const T37 &out)
 
     mRivers[who.index()].pushBack(out);
     mHands[who.index()].swapOut(out);
+    mAgaris[who.index()].invalidate();
+    exposeTile(who, out);
 
     discardEffects(who, false);
 }
@@ -784,6 +838,7 @@ void Table::spinOut(Who who)
 
     const T37 &out = mHands[who.index()].drawn();
     mRivers[who.index()].pushBack(out);
+    exposeTile(who, out);
     mHands[who.index()].spinOut();
 
     discardEffects(who, true);
@@ -798,6 +853,8 @@ void Table::barkOut(Who who, const T37 &out)
 {
     mRivers[who.index()].pushBack(out);
     mHands[who.index()].barkOut(out);
+    mAgaris[who.index()].invalidate();
+    exposeTile(who, out);
 
     discardEffects(who, false);
 }
@@ -921,6 +978,8 @@ void Table::chii(Who who, ActCode dir, const T37 &out, bool showAka5)
                      : dir == M ? &Hand::chiiAsMiddle : &Hand::chiiAsRight;
 
     (mHands[who.index()].*pChii)(getFocusTile(), showAka5);
+    mAgaris[who.index()].invalidate();
+    exposeBark(who, mHands[who.index()].barks().back());
 
     TableEvent event = TableEvent::Barked { who, mHands[who.index()].barks().back(), false };
     for (auto ob : mObservers)
@@ -941,6 +1000,8 @@ void Table::pon(Who who, const T37 &out, int showAka5)
 
     int layIndex = who.looksAt(mFocus.who());
     mHands[who.index()].pon(getFocusTile(), showAka5, layIndex);
+    mAgaris[who.index()].invalidate();
+    exposeBark(who, mHands[who.index()].barks().back());
 
     TableEvent event = TableEvent::Barked { who, mHands[who.index()].barks().back(), false };
     for (auto ob : mObservers)
@@ -961,6 +1022,8 @@ void Table::daiminkan(Who who)
 
     int layIndex = who.looksAt(mFocus.who());
     mHands[who.index()].daiminkan(getFocusTile(), layIndex);
+    mAgaris[who.index()].invalidate();
+    exposeBark(who, mHands[who.index()].barks().back());
 
     TableEvent event = TableEvent::Barked { who, mHands[who.index()].barks().back(), false };
     for (auto ob : mObservers)
@@ -1008,6 +1071,8 @@ void Table::ankan(Who who, T34 tile)
     int w = who.index();
     bool spin = mHands[w].drawn() == tile;
     mHands[w].ankan(tile);
+    mAgaris[w].invalidate();
+    exposeBark(who, mHands[w].barks().back());
     mFocus.focusOnChankan(who, mHands[who.index()].barks().size() - 1);
 
     TableEvent event = TableEvent::Barked { who, mHands[who.index()].barks().back(), spin };
@@ -1040,6 +1105,8 @@ void Table::kakan(Who who, int barkId)
     bool spin = mHands[w].drawn() == mHands[w].barks()[barkId][0];
 
     mHands[w].kakan(barkId);
+    mAgaris[w].invalidate();
+    exposeTile(who, mHands[w].barks()[barkId][3]);
     mFocus.focusOnChankan(who, barkId);
     const M37 &kanMeld = mHands[who.index()].barks()[barkId];
 
@@ -1211,7 +1278,8 @@ void Table::checkChankan(bool only13)
             Choices::ModeBark mode;
             mode.focus = getFocusTile();
             bool passiveDoujun = false;
-            mode.ron = mHands[w].canRon(getFocusTile(), getFormCtx(Who(w)), mRule, passiveDoujun);
+            mode.ron = mAgaris[w].canRon(mHands[w], getFocusTile(), getFormCtx(Who(w)),
+                                         mRule, passiveDoujun);
             assert(!passiveDoujun);
             if (mode.ron)
                 mChoicess[w].setBark(mode);
@@ -1236,7 +1304,8 @@ void Table::checkBarkRon()
         // ron
         if (mFuritens[w].none()) {
             bool passiveDoujun = false;
-            mode.ron = mHands[w].canRon(focus, getFormCtx(Who(w)), mRule, passiveDoujun);
+            mode.ron = mAgaris[w].canRon(mHands[w], focus, getFormCtx(Who(w)),
+                                         mRule, passiveDoujun);
             mFuritens[w].doujun = mFuritens[w].doujun || passiveDoujun;
         }
 
@@ -1270,8 +1339,9 @@ void Table::checkSutehaiFuriten()
     if (!mHands[w].ready())
         return;
 
-    for (T34 t : mHands[w].effA()) {
-        if (util::any(mRivers[w], [t](const T37 &r) { return r == t; })) {
+    const std::bitset<34> &agari = mAgaris[w].agari(mHands[w]);
+    for (const T37 &r : mRivers[w]) {
+        if (agari.test(r.id34())) {
             mFuritens[w].sutehai = true;
             return;
         }
@@ -1,11 +1,13 @@
 #ifndef SAKI_TABLE_H
 #define SAKI_TABLE_H
 
+#include "agari_cache.h"
 #include "choices.h"
 #include "kan_ctx.h"
 #include "mount.h"
 #include "table_env.h"
 #include "table_view.h"
+#include "table_view_real.h"
 #include "table_observer.h"
 #include "girl.h"
 #include "../form/tile_count.h"
@@ -56,7 +58,9 @@ protected:
     std::array<int, 4> mLayPositions;
     std::array<Furiten, 4> mFuritens;
     std::array<Hand, 4> mHands;
+    std::array<AgariCache, 4> mAgaris; ///< Must be invalidated with mHands
     std::array<River, 4> mRivers;
+    std::array<TileCount, 4> mVisibleRemains; ///< Must be updated with mHands, mRivers, and drids
     std::array<std::bitset<24>, 4> mPickeds;
     std::array<Choices, 4> mChoicess;
     std::array<Action, 4> mActionInbox;
@@ -95,6 +99,7 @@ public:
         std::array<std::unique_ptr<Girl>, 4> girls;
         Rule rule;
         Who tempDealer;
+        uint32_t seed = 0; ///< Initial state of the util::Rand, 0 for a time-based one
     };
 
     explicit Table(InitConfig config, std::vector<TableObserver *> obs, const TableEnv &env);
@@ -111,11 +116,12 @@ public:
     const River &getRiver(Who who) const;
     const Girl &getGirl(Who who) const;
     std::unique_ptr<TableView> getView(Who who) const;
+    TableViewReal getRealView(Who who) const;
     const Furiten &getFuriten(Who who) const;
     const std::array<int, 4> &getPoints() const;
     int getRound() const;
     int getExtraRound() const;
-    TileCount visibleRemain(Who who) const;
+    const TileCount &visibleRemain(Who who) const;
     int riverRemain(T34 t) const;
     int getRank(Who who) const;
     const TableFocus &getFocus() const;
@@ -154,6 +160,9 @@ private:
     void clean();
     void rollDice();
     void deal();
+    void resetVisibleRemains();
+    void exposeTile(Who owner, const T37 &t);
+    void exposeBark(Who who, const M37 &bark);
     void flipKandoraIndic();
     void notifyFlipped();
     void tryDraw(Who who);
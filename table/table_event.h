@@ -5,6 +5,7 @@
 #include "../unit/action.h"
 #include "../util/misc.h"
 
+#include <variant>
 #include <cstdint>
 
 
@@ -32,25 +33,6 @@ public:
         POINTS_CHANGED, TABLE_ENDED, POPPED_UP
     };
 
-    struct Args
-    {
-        virtual ~Args() = default;
-        virtual std::unique_ptr<Args> clone() = 0;
-    };
-
-    template<typename ArgsT>
-    struct ArgsCloneable : Args
-    {
-        explicit ArgsCloneable(const ArgsT &a) : args(a) {}
-
-        std::unique_ptr<Args> clone() override
-        {
-            return std::make_unique<ArgsCloneable>(*this);
-        }
-
-        ArgsT args;
-    };
-
     struct TableStarted
     {
         static const Type TYPE = Type::TABLE_STARTED;
@@ -158,17 +140,13 @@ public:
     template<typename ArgsT>
     TableEvent(ArgsT args)
         : mType(ArgsT::TYPE)
-        , mArgs(std::make_unique<ArgsCloneable<ArgsT>>(args))
+        , mArgs(std::move(args))
     {
     }
 
     ~TableEvent() = default;
 
-    TableEvent(const TableEvent &copy)
-        : mType(copy.mType)
-        , mArgs(copy.mArgs->clone())
-    {
-    }
+    TableEvent(const TableEvent &copy) = default;
 
     Type type() const
     {
@@ -179,12 +157,20 @@ public:
     const ArgsT &as() const
     {
         assert(mType == ArgsT::TYPE);
-        return (static_cast<const ArgsCloneable<ArgsT> &>(*mArgs)).args;
+        return *std::get_if<ArgsT>(&mArgs);
     }
 
 private:
+    ///
+    /// \brief Inline storage of any payload, no allocation on construction or copy
+    ///
+    using Args = std::variant<TableStarted, FirstDealerChosen, RoundStarted, Cleaned,
+                              Diced, Dealt, Flipped, Drawn, Discarded,
+                              RiichiCalled, RiichiEstablished, Barked, RoundEnded,
+                              PointsChanged, TableEnded, PoppedUp>;
+
     Type mType;
-    std::unique_ptr<Args> mArgs;
+    Args mArgs;
 };
 
 
@@ -21,7 +21,7 @@ void TableTester::run(bool fromHalfWay)
     // *INDENT-OFF*
     auto pickBusy = [&]() {
         for (Who who : whos::ALL4)
-            if (mTable.getView(who)->myChoices().any())
+            if (mTable.getChoices(who).any())
                 return who;
 
         return Who();
@@ -29,8 +29,8 @@ void TableTester::run(bool fromHalfWay)
     // *INDENT-ON*
 
     for (Who who = pickBusy(); who.somebody(); who = pickBusy()) {
-        auto view = mTable.getView(who);
-        auto decision = mDeciders[who.index()]->decide(*view);
+        TableViewReal view = mTable.getRealView(who);
+        auto decision = mDeciders[who.index()]->decide(view);
 
         if (decision.action.act() != ActCode::NOTHING)
             mTable.action(who, decision.action, mTable.getNonce(who));
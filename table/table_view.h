@@ -40,7 +40,7 @@ public:
     virtual const Rule &getRule() const = 0;
     virtual int getSelfWind(Who who) const = 0;
     virtual int getRoundWind() const = 0;
-    virtual TileCount visibleRemain() const = 0;
+    virtual const TileCount &visibleRemain() const = 0;
     virtual Who findGirl(Girl::Id id) const = 0;
 
     virtual const River &getRiver(Who who) const = 0;
@@ -75,7 +75,7 @@ int TableViewReal::getRoundWind() const
     return mTable.getRoundWind();
 }
 
-TileCount TableViewReal::visibleRemain() const
+const TileCount &TableViewReal::visibleRemain() const
 {
     return mTable.visibleRemain(mSelf);
 }
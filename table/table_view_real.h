@@ -34,7 +34,7 @@ public:
     const Rule &getRule() const override;
     int getSelfWind(Who who) const override;
     int getRoundWind() const override;
-    TileCount visibleRemain() const override;
+    const TileCount &visibleRemain() const override;
     Who findGirl(Girl::Id id) const override;
 
     const River &getRiver(Who who) const override;
@@ -0,0 +1,337 @@
+#include "bench.h"
+#include "test.h"
+#include "../form/tile_count_list.h"
+#include "../form/form.h"
+#include "../form/form_gb.h"
+#include "../form/form_gb_fast.h"
+#include "../app/gen.h"
+#include "../util/misc.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+
+
+#ifdef LIBSAKI_BENCH_ALLOC
+// counts every allocation of the process, only built into bench runs
+static std::atomic<uint64_t> benchAllocCt(0);
+
+void *operator new(std::size_t size)
+{
+    benchAllocCt.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size == 0 ? 1 : size))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+#endif
+
+
+
+namespace saki
+{
+
+
+
+///
+/// \brief Golden checksums of the bench corpus, update only on purpose
+///
+/// A changed checksum means some form scores differently. If that is
+/// intended, print the new values by running the benches and update.
+///
+static const uint64_t GOLDEN_FORM = 17794040109550411332ULL;
+static const uint64_t GOLDEN_FORM_GB = 12435424779427166540ULL;
+static const uint64_t GOLDEN_ESTIMATE = 13189597197914142691ULL;
+
+
+
+///
+/// \brief A winning tile of a ready hand, scored both as ron and tsumo
+///
+struct BenchWin
+{
+    Hand ready;
+    T37 pick;
+    FormCtx ctx;
+    util::Stactor<T37, 5> drids;
+};
+
+///
+/// \brief Mix 'x' into the FNV-1a hash 'h'
+///
+static void benchMix(uint64_t &h, uint64_t x)
+{
+    for (int i = 0; i < 8; i++) {
+        h ^= (x >> (8 * i)) & 0xFF;
+        h *= 0x100000001B3ULL;
+    }
+}
+
+static uint64_t benchAllocs()
+{
+#ifdef LIBSAKI_BENCH_ALLOC
+    return benchAllocCt.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+///
+/// \brief Vary winds, riichi, and dora by the index in the corpus
+///
+static void benchVary(BenchWin &win, int i)
+{
+    win.ctx.selfWind = 1 + i % 4;
+    win.ctx.roundWind = 1 + (i / 4) % 4;
+    win.ctx.riichi = win.ready.isMenzen() && i % 5 == 0 ? 1 : 0;
+    win.ctx.ippatsu = win.ctx.riichi && i % 10 == 0;
+    if (i % 3 == 0)
+        win.drids.pushBack(T37((7 * i) % 34));
+}
+
+///
+/// \brief Deterministic corpus of winning hands
+///
+/// Every other complete closed hand of some tile ranges from
+/// TileCountList, with every kind in it as the winning tile, plus the
+/// hands of Gen with a fixed seed, which have barks and situational yakus.
+///
+static std::vector<BenchWin> benchCorpus()
+{
+    using namespace tiles34;
+
+    std::vector<BenchWin> res;
+    const std::array<std::pair<T34, T34>, 3> ranges {
+        std::make_pair(1_p, 9_p), std::make_pair(8_s, 3_y), std::make_pair(5_m, 4_p)
+    };
+
+    int completeCt = 0;
+    for (const auto &range : ranges) {
+        for (const TileCount &full : TileCountList(14, range.first, range.second)) {
+            if (full.step(0) != -1 || completeCt++ % 2 != 0)
+                continue;
+
+            for (T34 t : full.t34s13()) {
+                TileCount closed(full);
+                T37 pick(t.id34());
+                closed.inc(pick, -1);
+                BenchWin win { Hand(closed), pick, FormCtx(), util::Stactor<T37, 5>() };
+                benchVary(win, res.size());
+                res.push_back(win);
+            }
+        }
+    }
+
+    util::Rand rand;
+    rand.set(2020);
+    Rule rule;
+    for (int i = 0; i < 20000; i++) {
+        int sw = 1 + i % 4;
+        int rw = 1 + (i / 4) % 4;
+        bool ron = i % 2 == 0;
+        Gen gen = i % 3 == 0 ? Gen::genForm4(rand, 60, 70, 30, sw, rw, rule, ron)
+                             : Gen::genForm4(rand, 20, 10, 30, sw, rw, rule, ron);
+        BenchWin win { gen.hand, gen.pick, gen.ctx, util::Stactor<T37, 5>() };
+        if (!ron)
+            win.ready.spinOut();
+
+        if (i % 3 == 0)
+            win.drids.pushBack(T37((7 * i) % 34));
+
+        res.push_back(win);
+    }
+
+    return res;
+}
+
+///
+/// \brief Run 'f' once per item of a bench, printing the numbers
+/// \param name Name of the bench
+/// \param ct Number of items
+/// \param f Called with the item index, mixing the results into the hash
+/// \return The checksum
+///
+template<typename F>
+static uint64_t benchRun(const char *name, int ct, F f)
+{
+    std::vector<int64_t> nanos;
+    nanos.reserve(ct);
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    uint64_t allocs = benchAllocs();
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < ct; i++) {
+        auto start = std::chrono::steady_clock::now();
+        f(i, hash);
+        auto end = std::chrono::steady_clock::now();
+        nanos.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+
+    auto total = std::chrono::steady_clock::now() - begin;
+    allocs = benchAllocs() - allocs;
+
+    double secs = std::chrono::duration<double>(total).count();
+    auto p99 = nanos.begin() + nanos.size() * 99 / 100;
+    std::nth_element(nanos.begin(), p99, nanos.end());
+
+    util::p(name, ct, "items", static_cast<int64_t>(ct / secs), "per sec",
+            "p99", *p99 / 1000.0, "us");
+#ifdef LIBSAKI_BENCH_ALLOC
+    util::p(name, static_cast<double>(allocs) / ct, "allocs per item");
+#endif
+    util::p(name, "checksum", hash);
+
+    return hash;
+}
+
+///
+/// \brief Stop the process if a bench checksum is not the expected one
+///
+/// Not an assertion, so that release builds of the benches check too.
+///
+static void benchCheck(const char *name, uint64_t hash, uint64_t expected)
+{
+    if (hash != expected) {
+        util::p(name, "checksum mismatch, expected", expected);
+        std::abort();
+    }
+}
+
+///
+/// \brief Winning hands of corpus[0], corpus[stride], ... with the tile drawn
+///
+static std::vector<Hand> benchFulls(const std::vector<BenchWin> &corpus, int stride)
+{
+    std::vector<Hand> res;
+    res.reserve(corpus.size() / stride + 1);
+    for (size_t i = 0; i < corpus.size(); i += stride) {
+        res.push_back(corpus[i].ready);
+        res.back().draw(corpus[i].pick);
+    }
+
+    return res;
+}
+
+void benchAll()
+{
+    benchForm();
+    benchFormGb();
+    benchEstimate();
+}
+
+///
+/// \brief Ron and tsumo forms of the whole corpus
+///
+void benchForm()
+{
+    TestScope test("bench form", true);
+
+    std::vector<BenchWin> corpus = benchCorpus();
+    std::vector<Hand> fulls = benchFulls(corpus, 1);
+    Rule rule;
+
+    // *INDENT-OFF*
+    uint64_t hash = benchRun("form", 2 * corpus.size(), [&](int i, uint64_t &h) {
+        const BenchWin &win = corpus[i / 2];
+        Form form = i % 2 == 0 ? Form(win.ready, win.pick, win.ctx, rule, win.drids)
+                               : Form(fulls[i / 2], win.ctx, rule, win.drids);
+        benchMix(h, form.hasYaku());
+        benchMix(h, form.fu());
+        benchMix(h, form.han());
+        benchMix(h, form.gain());
+        benchMix(h, form.dora());
+        benchMix(h, form.yakus().to_ullong());
+    });
+    // *INDENT-ON*
+
+    benchCheck("form", hash, GOLDEN_FORM);
+}
+
+///
+/// \brief GB ron and tsumo forms of a part of the corpus
+///
+/// FormGb is slow on one-suit hands, so only every GB_STRIDE-th win is
+/// taken. FormGbFast runs on the same part and must give the same sum.
+///
+void benchFormGb()
+{
+    TestScope test("bench form-gb", true);
+
+    const int GB_STRIDE = 8;
+    std::vector<BenchWin> corpus = benchCorpus();
+    std::vector<Hand> fulls = benchFulls(corpus, GB_STRIDE);
+    const int ct = 2 * (corpus.size() / GB_STRIDE);
+
+    // *INDENT-OFF*
+    auto mix = [](uint64_t &h, int fan, FormGb::Fans fans) {
+        std::sort(fans.begin(), fans.end());
+        benchMix(h, fan);
+        for (Fan f : fans)
+            benchMix(h, f);
+    };
+
+    uint64_t hash = benchRun("form-gb", ct, [&](int i, uint64_t &h) {
+        const BenchWin &win = corpus[i / 2 * GB_STRIDE];
+        bool juezhang = i % 7 == 0;
+        FormGb form = i % 2 == 0 ? FormGb(win.ready, win.pick, win.ctx, juezhang)
+                                 : FormGb(fulls[i / 2], win.ctx, juezhang);
+        mix(h, form.fan(), form.fans());
+    });
+
+    uint64_t fastHash = benchRun("form-gb-fast", ct, [&](int i, uint64_t &h) {
+        const BenchWin &win = corpus[i / 2 * GB_STRIDE];
+        bool juezhang = i % 7 == 0;
+        FormGbFast form = i % 2 == 0 ? FormGbFast(win.ready, win.pick, win.ctx, juezhang)
+                                     : FormGbFast(fulls[i / 2], win.ctx, juezhang);
+        mix(h, form.fan(), form.fans());
+    });
+    // *INDENT-ON*
+
+    benchCheck("form-gb", hash, GOLDEN_FORM_GB);
+    benchCheck("form-gb-fast", fastHash, GOLDEN_FORM_GB);
+}
+
+///
+/// \brief Hand::estimate() of the menzen ready hands in the corpus
+///
+void benchEstimate()
+{
+    TestScope test("bench estimate", true);
+
+    std::vector<BenchWin> corpus = benchCorpus();
+    // *INDENT-OFF*
+    corpus.erase(std::remove_if(corpus.begin(), corpus.end(), [](const BenchWin &win) {
+        return !win.ready.isMenzen();
+    }), corpus.end());
+    // *INDENT-ON*
+
+    Rule rule;
+
+    // *INDENT-OFF*
+    uint64_t hash = benchRun("estimate", corpus.size(), [&](int i, uint64_t &h) {
+        const BenchWin &win = corpus[i];
+        benchMix(h, win.ready.estimate(rule, win.ctx.selfWind, win.ctx.roundWind, win.drids));
+    });
+    // *INDENT-ON*
+
+    benchCheck("estimate", hash, GOLDEN_ESTIMATE);
+}
+
+
+
+} // namespace saki
@@ -0,0 +1,23 @@
+#ifndef SAKI_BENCH_H
+#define SAKI_BENCH_H
+
+
+
+namespace saki
+{
+
+
+
+void benchAll();
+
+void benchForm();
+void benchFormGb();
+void benchEstimate();
+
+
+
+} // namespace saki
+
+
+
+#endif // SAKI_BENCH_H
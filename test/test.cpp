@@ -1,13 +1,24 @@
 #include "test.h"
 #include "../form/tile_count_list.h"
+#include "../form/packed_tile_count.h"
+#include "../form/parse_cache.h"
+#include "../form/step_table_file.h"
 #include "../form/form.h"
+#include "../form/lazy_form.h"
+#include "../form/wait_table.h"
 #include "../form/form_gb.h"
+#include "../form/form_gb_fast.h"
 #include "../table/table_tester.h"
 #include "../table/table_env_stub.h"
 #include "../ai/ai.h"
+#include "../app/gen_bank.h"
+#include "../app/self_play.h"
 #include "../util/string_enum.h"
 #include "../util/misc.h"
 
+#include <atomic>
+#include <mutex>
+#include <cstdio>
 #include <cstring>
 
 
@@ -38,18 +49,50 @@ TestScope::~TestScope()
 
 
 
+///
+/// \brief Run 'check' on all items of 'tcl' with all cores, printing progress
+///
+/// Abort once 'check' returns false
+///
+static void testParallel(const TileCountList &tcl, const std::function<bool(const TileCount &)> &check)
+{
+    const int partCt = 100;
+    std::vector<TileCountList> parts = tcl.split(partCt);
+    std::atomic<int> done(0);
+    std::mutex mutex;
+
+    util::ThreadPool pool;
+    // *INDENT-OFF*
+    pool.run(partCt, [&](int i) {
+        for (const TileCount &tc : parts[i])
+            if (!check(tc))
+                std::abort();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        util::p(++done * 100 / partCt, "%");
+    });
+    // *INDENT-ON*
+}
+
 void testAll()
 {
     // *INDENT-OFF*
 //    testUtil();
 //    testTileCount();
+//    testStepTable();
+//    testStepTableFile();
 //    testParse4();
 //    testParse7And13();
     testParseAll();
+//    testParseCache();
 //    testHand();
+//    testExplain4();
 //    testForm();
 //    testFormGb();
+//    testFormGbFast();
+//    testGenBank();
 //    testTable();
+//    testSelfPlay();
     // *INDENT-ON*
 }
 
@@ -61,6 +104,24 @@ void testUtil()
     assert(!util::all(v, [](int i) { return i > 2; }));
     std::array<int, 4> a { 1, 2, 3 };
     assert(util::all(a, [](const int &i) { return i < 7; }));
+
+    // reference SplitMix64 with seed 0 starts with 0xe220a8397b1dcdaf
+    util::Rand sm = util::Rand::splitMix(0);
+    assert(sm.gen() == static_cast<int32_t>(0xe220a8397b1dcdafULL >> 33));
+
+    util::Rand mt;
+    mt.set(2018);
+    util::Rand s1 = mt.split(1);
+    util::Rand s2 = mt.split(2);
+    assert(mt.state() == 2018 && s1.mode() == util::Rand::Mode::SPLIT_MIX);
+    util::Rand s1Again = mt.split(1);
+    for (int i = 0; i < 100; i++) {
+        int32_t r = s1.gen();
+        assert(r == s1Again.gen() && r != s2.gen());
+    }
+
+    assert(s1.split(7).gen() == s1Again.split(7).gen());
+    assert(s1.split(7).gen() != s2.split(7).gen());
 }
 
 void testTileCount()
@@ -71,6 +132,103 @@ void testTileCount()
     TileCount tc { 1_m, 1_m, 1_m, 2_p, 2_p, 2_p, 3_s, 3_s, 3_s, 4_f, 4_f, 4_f, 1_y, 1_y };
     assert(tc.step4(0) == -1);
     assert(tc.step(0) == -1);
+
+    TileCount full(TileCount::AKADORA4);
+    PackedTileCount packed(full);
+    assert(packed.unpack().covers(full) && full.covers(packed.unpack()));
+    assert(packed.sum() == full.sum() && packed.ctYao() == full.ctYao());
+    assert(packed.ct(Suit::P) == full.ct(Suit::P) && packed.ct(Suit::Y) == full.ct(Suit::Y));
+    assert(packed.ct(0_p) == 2 && packed.ct(5_p) == 2 && packed.ct(T34(5_p)) == 4);
+
+    full -= tc;
+    packed -= PackedTileCount(tc);
+    assert(packed == PackedTileCount(full));
+    assert(packed.covers(PackedTileCount(tc)) == full.covers(tc));
+    assert(!PackedTileCount(tc).covers(packed));
+    assert(packed.ctZ() == full.ctZ() && packed.ctAka5() == full.ctAka5());
+
+    // slices seek to the same items as walking
+    TileCountList tcl(5, T34(1_s), T34(1_f));
+    std::vector<TileCountList> parts = tcl.split(7);
+    uint64_t rank = 0;
+    for (TileCountList &part : parts) {
+        for (const TileCount &item : part) {
+            const TileCount at = tcl.at(rank++);
+            assert(at.covers(item) && item.covers(at));
+        }
+    }
+
+    assert(rank == tcl.size() && rank == 1992);
+}
+
+void testStepTable()
+{
+    TestScope test("step table", true);
+
+    using namespace tiles34;
+
+    // *INDENT-OFF*
+    std::mutex mutex;
+
+    auto fail = [&mutex](const TileCount &tc, const char *what) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (T34 t : tiles34::ALL34)
+            for (int i = 0; i < tc.ct(t); i++)
+                std::cout << t;
+        util::p("", what);
+        std::abort();
+    };
+
+    util::ThreadPool pool;
+
+    auto check = [&fail, &pool](int sum, T34 min, T34 max) {
+        TileCountList(sum, min, max).forEach(pool, [sum, &fail](const TileCount &tc) {
+            int old = tc.step4ByCut(0);
+            if (tc.step4(0) != old || tc.step4(1) != tc.step4ByCut(1))
+                fail(tc, "step4");
+
+            if (sum == 14)
+                return;
+
+            std::bitset<34> effA = tc.effA4Set(0);
+            for (T34 t : tiles34::ALL34) {
+                bool oldEff = !tc.dislike4(t) && tc.peekDraw(t, &TileCount::step4ByCut, 0) < old;
+                if (oldEff != effA[t.id34()])
+                    fail(tc, "effA4");
+            }
+        });
+    };
+    // *INDENT-ON*
+
+    for (int sum : { 13, 14 }) {
+        check(sum, 1_p, 9_p);
+        check(sum, 8_s, 3_y);
+    }
+}
+
+void testStepTableFile()
+{
+    TestScope test("step table file");
+
+    const char *path = "saki_step_table_test.bin";
+    assert(StepTableFile::write(path));
+
+    std::unique_ptr<StepTableFile> file = StepTableFile::read(path);
+    assert(file != nullptr);
+
+    // rank 0 of each kind is the all-zero vector, the head of the data
+    const StepTable &table = StepTable::instance();
+    std::array<int, StepTable::NUM_KIND> zeros {};
+    size_t numBytes = sizeof(StepTable::Works) * file->numCt();
+    size_t honorBytes = sizeof(StepTable::Works) * file->honorCt();
+    assert(std::memcmp(file->nums(), table.num(zeros.data()), numBytes) == 0);
+    assert(std::memcmp(file->honors(), table.honor(zeros.data()), honorBytes) == 0);
+
+    // too late after the table is in use
+    assert(!StepTableFile::load(path));
+
+    std::remove(path);
+    assert(StepTableFile::read(path) == nullptr);
 }
 
 void testParse4()
@@ -83,26 +241,19 @@ void testParse7And13()
 
     using namespace tiles37;
 
-    TileCountList tcl(13, 1_p, 9_p);
-    int prevPercent = 0;
-    for (const TileCount &tc : tcl) {
-        int currProg = tc.ct(1_p) * 16 + tc.ct(2_p) * 4 + tc.ct(3_p);
-        int percent = (currProg * 100) / 128;
-        if (percent != prevPercent) {
-            util::p(percent, "%");
-            prevPercent = percent;
-        }
-
+    // *INDENT-OFF*
+    testParallel(TileCountList(13, 1_p, 9_p), [](const TileCount &tc) {
         auto parsed = tc.parse7();
         int step = parsed.step7();
-
-        if (step != tc.step7()) {
-            util::p(tc.t37s13(true));
-            util::p("old", tc.step7());
-            util::p("new", step);
-            std::abort();
-        }
-    }
+        if (step == tc.step7())
+            return true;
+
+        util::p(tc.t37s13(true));
+        util::p("old", tc.step7());
+        util::p("new", step);
+        return false;
+    });
+    // *INDENT-ON*
 }
 
 void testParseAll()
@@ -111,25 +262,55 @@ void testParseAll()
 
     using namespace tiles37;
 
-    TileCountList tcl(13, 1_p, 9_p);
-    int prevPercent = 0;
-    for (const TileCount &tc : tcl) {
-        int currProg = tc.ct(1_p) * 16 + tc.ct(2_p) * 4 + tc.ct(3_p);
-        int percent = (currProg * 100) / 128;
-        if (percent != prevPercent) {
-            util::p(percent, "%");
-            prevPercent = percent;
-        }
-
+    // *INDENT-OFF*
+    testParallel(TileCountList(13, 1_p, 9_p), [](const TileCount &tc) {
         int step = tc.parse(0).step();
         int old = tc.step(0);
-        if (step != old) {
-            util::p(tc.t37s13(true));
-            util::p("old", old);
-            util::p("new", step);
-            std::abort();
-        }
-    }
+        if (step == old)
+            return true;
+
+        util::p(tc.t37s13(true));
+        util::p("old", old);
+        util::p("new", step);
+        return false;
+    });
+    // *INDENT-ON*
+}
+
+void testParseCache()
+{
+    TestScope test("parse cache");
+
+    using namespace tiles37;
+    ParseCache &cache = ParseCache::instance();
+    cache.clear();
+    cache.resetStats();
+
+    TileCount tc { 1_m, 2_m, 3_m, 3_m, 4_m, 2_p, 3_p, 4_p, 6_s, 7_s, 1_f, 1_f, 1_y };
+    Parsed4s miss = tc.parse4(0);
+    Parsed4s hit = tc.parse4(0);
+    assert(cache.misses() == 1 && cache.hits() == 1);
+    assert(std::equal(miss.begin(), miss.end(), hit.begin()));
+    assert(hit.effA4Set() == tc.parse4Uncached(0).effA4Set());
+
+    tc.parse4(1); // different bark count, different key
+    assert(cache.misses() == 2 && cache.size() == 2);
+
+    // same hand with m and p swapped shares the canonical entry
+    TileCount swapped { 1_p, 2_p, 3_p, 3_p, 4_p, 2_m, 3_m, 4_m, 6_s, 7_s, 1_f, 1_f, 1_y };
+    Parsed4s iso = swapped.parse4(0);
+    assert(cache.hits() == 2 && cache.size() == 2);
+    Parsed4s isoUncached = swapped.parse4Uncached(0);
+    assert(iso.size() == isoUncached.size());
+    assert(iso.effA4Set() == isoUncached.effA4Set());
+    for (const Parsed4 &p : iso)
+        assert(util::has(isoUncached, p));
+
+    cache.setCapacity(0);
+    tc.parse4(0);
+    assert(cache.hits() == 2 && cache.size() == 0);
+
+    cache.setCapacity(ParseCache::DEFAULT_CAPACITY);
 }
 
 void testHand()
@@ -143,6 +324,77 @@ void testHand()
 
     hand.draw(1_y);
     assert(hand.step() == -1);
+
+    // incremental steps stay in sync with peeks and real deltas
+    assert(hand.peekSwap(1_m, &Hand::step4) == 0);
+    assert(hand.peekSwap(1_m, &Hand::effA4Set) == hand.peekSwap(1_m, &Hand::parse4).effA4Set());
+    hand.swapOut(1_y);
+    assert(hand.step() == 0);
+    assert(hand.effASet() == hand.parse().effASet());
+
+    // effB of discarding the drawn 9s equals one-by-one lookahead
+    TileCount close { 1_m, 2_m, 4_m, 5_m, 2_p, 3_p, 7_p, 8_p, 3_s, 3_s, 6_s, 1_f, 1_y };
+    TileCount remain(TileCount::AKADORA0);
+    remain -= close;
+    Hand shape(close);
+    shape.draw(9_s);
+    util::Stactor<Hand::DiscardEval, 14> evals = shape.evaluateDiscards(remain);
+    shape.evaluateEffB(evals, remain);
+    const Hand::DiscardEval &eval = evals[10]; // kinds in order, 9s is the 11th
+    assert(eval.out == 9_s);
+
+    shape.spinOut();
+    assert(eval.step == shape.step() && eval.effA == shape.effASet());
+
+    int effB = 0;
+    for (T34 in : shape.effA()) {
+        remain.inc(T37(in.id34()), -1);
+        int best = 0;
+        for (T34 out : tiles34::ALL34) {
+            Hand next(shape);
+            next.draw(T37(in.id34()));
+            if (next.ct(out) == 0)
+                continue;
+
+            if (next.drawn() == out)
+                next.spinOut();
+            else
+                next.swapOut(T37(out.id34()));
+
+            if (next.step() < eval.step)
+                best = std::max(best, remain.ct(next.effA()));
+        }
+
+        remain.inc(T37(in.id34()), 1);
+        effB += remain.ct(in) * best;
+    }
+
+    assert(eval.remainEffB == effB && effB > 0);
+}
+
+void testExplain4()
+{
+    TestScope test("explain4");
+
+    using namespace tiles34;
+
+    // capacity of explanations, number suits are symmetric
+    for (const TileCount &full : TileCountList(14, 1_m, 9_m)) {
+        if (full.step4(0) != -1)
+            continue;
+
+        for (T34 pick : tiles34::ALL34) {
+            if (full.ct(pick) == 0)
+                continue;
+
+            TileCount ready(full);
+            ready.inc(T37(pick.id34()), -1);
+            TileCount::Explain4Closeds closeds = ready.explain4(pick);
+            assert(closeds.size() <= 4);
+            assert(Explain4::make(closeds, util::Stactor<M37, 4>(), pick, true).size() <= 12);
+            assert(Explain4::make(closeds, util::Stactor<M37, 4>(), pick, false).size() <= 12);
+        }
+    }
 }
 
 void testForm()
@@ -162,6 +414,86 @@ void testForm()
     assert(form.hasYaku());
     assert(form.han() == 1);
     assert(form.spell() == "PnfNmi");
+
+    // wait table forms are the same as the ones built one by one
+    WaitTable table(hand, ctx, rule);
+    assert(table.size() == 2 && table.find(6_s) != -1 && table.find(5_s) == -1);
+    for (int i = 0; i < table.size(); i++) {
+        T37 pick(table.pick(i).id34());
+        Hand full(hand);
+        full.draw(pick);
+        Form ron(hand, pick, ctx, rule);
+        Form tsumo(full, ctx, rule);
+        assert(table.hasRonYaku(i) == ron.hasYaku());
+        assert(table.ron(i).spell() == ron.spell() && table.ron(i).charge() == ron.charge());
+        assert(table.tsumo(i).spell() == tsumo.spell() && table.tsumo(i).charge() == tsumo.charge());
+    }
+
+    assert(table.maxRonGain() == hand.estimate(rule, 1, 1, util::Stactor<T37, 5>()));
+
+    // lazy forms and wait tables agree with full ones on random complete hands
+    util::Rand rand;
+    rand.set(2019);
+    for (int i = 0; i < 20000; i++) {
+        std::array<int, 34> used {};
+        TileCount closed;
+        util::Stactor<M37, 4> barks;
+        int barkCt = rand.gen(3);
+        bool ok = true;
+
+        for (int m = 0; m < 4 && ok; m++) {
+            if (rand.gen(2) == 0) {
+                T37 l(9 * rand.gen(3) + rand.gen(7));
+                T37 c(l.next().id34());
+                T37 r(c.next().id34());
+                ok = ++used[l.id34()] <= 4 && ++used[c.id34()] <= 4 && ++used[r.id34()] <= 4;
+                if (m < barkCt) {
+                    barks.pushBack(M37::chii(l, c, r, 0));
+                } else {
+                    closed.inc(l, 1);
+                    closed.inc(c, 1);
+                    closed.inc(r, 1);
+                }
+            } else {
+                T37 t(rand.gen(34));
+                ok = (used[t.id34()] += 3) <= 4;
+                if (m < barkCt)
+                    barks.pushBack(M37::pon(t, t, t, 0));
+                else
+                    closed.inc(t, 3);
+            }
+        }
+
+        T37 pair(rand.gen(34));
+        if (!ok || (used[pair.id34()] += 2) > 4)
+            continue;
+
+        closed.inc(pair, 2);
+        util::Stactor<T34, 13> kinds = closed.t34s13();
+        T37 pick(kinds[rand.gen(kinds.size())].id34());
+        closed.inc(pick, -1);
+
+        Hand ready(closed, barks);
+        Hand full(ready);
+        full.draw(pick);
+
+        FormCtx rctx;
+        rctx.selfWind = 1 + rand.gen(4);
+        rctx.roundWind = 1 + rand.gen(4);
+        rctx.riichi = ready.isMenzen() && rand.gen(4) == 0;
+        rctx.emptyMount = rand.gen(16) == 0;
+
+        LazyForm lazyRon(ready, pick, rctx, rule);
+        LazyForm lazyTsumo(full, rctx, rule);
+        Form ron(ready, pick, rctx, rule);
+        Form tsumo(full, rctx, rule);
+        assert(lazyRon.hasYaku() == ron.hasYaku() && lazyRon.gain() == ron.gain());
+        assert(lazyTsumo.hasYaku() == tsumo.hasYaku() && lazyTsumo.gain() == tsumo.gain());
+
+        WaitTable waits(ready, rctx, rule);
+        int w = waits.find(pick);
+        assert(w != -1 && waits.hasRonYaku(w) == ron.hasYaku());
+    }
 }
 
 void testTable()
@@ -225,6 +557,192 @@ void testFormGb()
     }
 }
 
+///
+/// \brief Compare FormGbFast against FormGb on random complete hands
+///
+void testFormGbFast()
+{
+    TestScope test("form-gb-fast");
+
+    util::Rand rand;
+    rand.set(2018);
+
+    // *INDENT-OFF*
+    // biased to one suit plus honors half of the time to hit more fans
+    auto genHead = [&rand](int suit, bool seq) {
+        if (!seq && rand.gen(3) == 0)
+            return T34(27 + rand.gen(7));
+        int s = suit < 0 ? rand.gen(3) : suit;
+        return T34(9 * s + rand.gen(seq ? 7 : 9));
+    };
+    // *INDENT-ON*
+
+    int checked = 0;
+    while (checked < 20000) {
+        int suit = rand.gen(2) == 0 ? -1 : rand.gen(3);
+        int barkCt = rand.gen(5);
+        std::array<int, 34> used {};
+        TileCount closed;
+        util::Stactor<M37, 4> barks;
+        bool ok = true;
+
+        for (int i = 0; i < 4 && ok; i++) {
+            int kind = rand.gen(4); // seq, seq, triplet, kan
+            T34 h = genHead(suit, kind <= 1);
+            T37 t(h.id34());
+            if (kind <= 1) {
+                T37 m(h.next().id34());
+                T37 r(h.nnext().id34());
+                ok = ++used[t.id34()] <= 4 && ++used[m.id34()] <= 4 && ++used[r.id34()] <= 4;
+                if (i < barkCt) {
+                    barks.pushBack(M37::chii(t, m, r, 0));
+                } else {
+                    closed.inc(t, 1);
+                    closed.inc(m, 1);
+                    closed.inc(r, 1);
+                }
+            } else if (kind == 2) {
+                ok = (used[t.id34()] += 3) <= 4;
+                if (i < barkCt)
+                    barks.pushBack(M37::pon(t, t, t, 0));
+                else
+                    closed.inc(t, 3);
+            } else {
+                ok = (used[t.id34()] += 4) <= 4;
+                barks.pushBack(i < barkCt ? M37::daiminkan(t, t, t, t, 0) : M37::ankan(t, t, t, t));
+            }
+        }
+
+        T34 pair = genHead(suit, false);
+        if (!ok || (used[pair.id34()] += 2) > 4)
+            continue;
+
+        closed.inc(T37(pair.id34()), 2);
+        util::Stactor<T34, 13> kinds = closed.t34s13();
+        T37 pick(kinds[rand.gen(kinds.size())].id34());
+        closed.inc(pick, -1);
+
+        Hand ready(closed, barks);
+        Hand full(ready);
+        full.draw(pick);
+
+        FormCtx ctx;
+        ctx.selfWind = 1 + rand.gen(4);
+        ctx.roundWind = 1 + rand.gen(4);
+        ctx.duringKan = rand.gen(8) == 0;
+        ctx.emptyMount = rand.gen(8) == 0;
+        bool juezhang = rand.gen(4) == 0;
+
+        FormGb ron(ready, pick, ctx, juezhang);
+        FormGb tsumo(full, ctx, juezhang);
+        FormGbFast fastRon(ready, pick, ctx, juezhang);
+        FormGbFast fastTsumo(full, ctx, juezhang);
+
+        FormGb::Fans ronFans = ron.fans();
+        FormGb::Fans tsumoFans = tsumo.fans();
+        std::sort(ronFans.begin(), ronFans.end());
+        std::sort(tsumoFans.begin(), tsumoFans.end());
+
+        assert(ron.fan() == fastRon.fan() && ronFans == fastRon.fans());
+        assert(tsumo.fan() == fastTsumo.fan() && tsumoFans == fastTsumo.fans());
+        checked++;
+    }
+}
+
+void testGenBank()
+{
+    TestScope test("gen-bank", true);
+
+    util::Rand rand;
+    rand.set(2018);
+    Rule rule;
+    util::ThreadPool pool;
+    std::vector<Gen> batch;
+
+    for (bool ron : { false, true }) {
+        GenBank bank(1, 1, rule, ron);
+        bank.fill(pool, rand, 100000);
+
+        // hard buckets of the rejection loops must be served
+        assert(bank.hasFuHan(70, 4) && bank.hasFuHan(110, 2));
+        assert(ron || (bank.hasFuHan(20, 2) && bank.hasFuHan(100, 1)));
+
+        long long worst = 0;
+        for (int fu = 20; fu <= 110; fu += fu == 20 ? 5 : 10) {
+            for (int han = 1; han <= 4; han++) {
+                if (!bank.hasFuHan(fu, han))
+                    continue;
+
+                for (int i = 0; i < 100; i++) {
+                    auto start = std::chrono::steady_clock::now();
+                    Gen gen = bank.genForm4FuHan(rand, fu, han);
+                    auto end = std::chrono::steady_clock::now();
+                    auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+                    worst = std::max<long long>(worst, us.count());
+                    assert(gen.form.fu() == fu && gen.form.han() == han);
+                }
+            }
+        }
+
+        for (int han = 5; han <= 12; han++) {
+            assert(bank.hasMangan(han));
+            batch.clear();
+            bank.genForm4Mangans(rand, han, 100, batch);
+            assert(batch.size() == 100);
+            for (const Gen &gen : batch)
+                assert(gen.form.han() == han && gen.form.manganType() != ManganType::HR);
+        }
+
+        util::p(ron ? "ron" : "tsumo", "worst", worst, "us");
+    }
+}
+
+///
+/// \brief Stats of a self-play run must not depend on the thread count
+///
+void testSelfPlay()
+{
+    TestScope test("self-play", true);
+
+    SelfPlay::Config config;
+    config.girlIds = { 714915, 712715, 710113, 713314 };
+    config.rule.roundLimit = 4;
+    config.seed = 2020;
+    config.tableCt = 12;
+
+    util::ThreadPool single(1);
+    util::ThreadPool multi(4);
+    int reportCt = 0;
+    // *INDENT-OFF*
+    SelfPlay::Stats a = SelfPlay::run(config, single, [&](const SelfPlay::Stats &s) {
+        assert(s.tableCt <= config.tableCt);
+        reportCt++;
+    });
+    // *INDENT-ON*
+    SelfPlay::Stats b = SelfPlay::run(config, multi, nullptr);
+
+    assert(reportCt == 1);
+    assert(a.tableCt == config.tableCt && b.tableCt == config.tableCt);
+    assert(a.roundCt == b.roundCt);
+    assert(a.ranks == b.ranks);
+    assert(a.points == b.points && a.scores == b.scores);
+    assert(a.tsumos == b.tsumos && a.rons == b.rons && a.gunneds == b.gunneds);
+    assert(a.results == b.results);
+
+    int64_t sum = 0;
+    for (int g = 0; g < 4; g++) {
+        int rankSum = 0;
+        for (int r = 0; r < 4; r++)
+            rankSum += a.ranks[g][r];
+
+        assert(rankSum == config.tableCt);
+        sum += a.points[g];
+        util::p(config.girlIds[g], "rank", a.avgRank(g), "win", a.winRate(g));
+    }
+
+    assert(sum == 100000LL * config.tableCt);
+}
+
 
 
 } // namespace saki
@@ -27,13 +27,20 @@ void testAll();
 
 void testUtil();
 void testTileCount();
+void testStepTable();
+void testStepTableFile();
 void testParse4();
 void testParse7And13();
 void testParseAll();
+void testParseCache();
 void testHand();
+void testExplain4();
 void testForm();
 void testFormGb();
+void testFormGbFast();
+void testGenBank();
 void testTable();
+void testSelfPlay();
 
 
 
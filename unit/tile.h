@@ -140,7 +140,7 @@ public:
 
     const char *str34() const
     {
-        static const std::array<const char *, 34> STRS {
+        static constexpr std::array<const char *, 34> STRS {
             "1m", "2m", "3m", "4m", "5m", "6m", "7m", "8m", "9m",
             "1p", "2p", "3p", "4p", "5p", "6p", "7p", "8p", "9p",
             "1s", "2s", "3s", "4s", "5s", "6s", "7s", "8s", "9s",
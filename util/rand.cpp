@@ -1,5 +1,6 @@
 #include "rand.h"
 
+#include <cassert>
 #include <chrono>
 #include <sstream>
 #include <iostream>
@@ -18,6 +19,42 @@ namespace util
 
 
 
+static const uint64_t GOLDEN_GAMMA = 0x9e3779b97f4a7c15ULL;
+
+///
+/// \brief Output function of SplitMix64
+///
+static uint64_t randMix(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+///
+/// \brief Finalizer of MurmurHash3, unrelated to randMix() to derive keys
+///
+static uint64_t randMixKey(uint64_t z)
+{
+    z = (z ^ (z >> 33)) * 0xff51afd7ed558ccdULL;
+    z = (z ^ (z >> 33)) * 0xc4ceb9fe1a85ec53ULL;
+    return z ^ (z >> 33);
+}
+
+///
+/// \brief Create a counter-based Rand
+///
+/// The 64-bit outputs are those of the reference SplitMix64 with 'seed'.
+///
+Rand Rand::splitMix(uint64_t seed)
+{
+    Rand res;
+    res.mMode = Mode::SPLIT_MIX;
+    res.mKey = seed;
+    res.mCounter = 0;
+    return res;
+}
+
 Rand::Rand()
     : mDist(0, 2147483647)
 {
@@ -25,9 +62,30 @@ Rand::Rand()
     mGen.seed(s);
 }
 
+///
+/// \brief Generate a number in [min(), max()]
+///
+Rand::result_type Rand::operator()()
+{
+    if (mMode == Mode::MINSTD)
+        return mGen();
+
+    while (true) {
+        result_type r = static_cast<result_type>(next64() >> 33);
+        if (min() <= r && r <= max())
+            return r;
+    }
+}
+
+///
+/// \brief Generate a number in [0, 2147483647]
+///
 int32_t Rand::gen()
 {
-    return mDist(mGen);
+    if (mMode == Mode::MINSTD)
+        return mDist(mGen);
+
+    return static_cast<int32_t>(next64() >> 33);
 }
 
 int32_t Rand::gen(int32_t mod)
@@ -35,27 +93,54 @@ int32_t Rand::gen(int32_t mod)
     return gen() % mod;
 }
 
+///
+/// \pre mode() == Mode::MINSTD
+///
 uint32_t Rand::state() const
 {
+    assert(mMode == Mode::MINSTD);
+
     std::ostringstream oss;
     oss << mGen;
     std::string str(oss.str());
     return std::strtoul(str.c_str(), nullptr, 10);
 }
 
+///
+/// \brief Restore a state got from state(), switching to Mode::MINSTD
+///
 void Rand::set(uint32_t state)
 {
+    mMode = Mode::MINSTD;
+
     std::stringstream ss;
     ss << state;
     ss >> mGen;
 }
 
+Rand::Mode Rand::mode() const
+{
+    return mMode;
+}
+
 ///
-/// \brief Get reference to the Uniform Random Bit Generator
+/// \brief Derive an independent counter-based stream
 ///
-std::minstd_rand &Rand::getUrbg()
+/// The result depends only on the current state of this Rand and
+/// 'streamId', and this Rand is not advanced. Splitting one parent by
+/// distinct ids gives streams that can be consumed in any order or by
+/// any threads with reproducible outputs.
+///
+Rand Rand::split(uint64_t streamId) const
+{
+    uint64_t base = mMode == Mode::MINSTD ? state() : mKey + mCounter * GOLDEN_GAMMA;
+    uint64_t salt = randMix(streamId * GOLDEN_GAMMA + 0x632be59bd9b4e019ULL);
+    return splitMix(randMixKey(randMixKey(base) ^ salt));
+}
+
+uint64_t Rand::next64()
 {
-    return mGen;
+    return randMix(mKey + ++mCounter * GOLDEN_GAMMA);
 }
 
 
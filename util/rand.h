@@ -16,24 +16,63 @@ namespace util
 
 
 
+///
+/// \brief Random number source of tables, girls, and generators
+///
+/// A Rand runs in one of two modes:
+/// - MINSTD, the default, wraps a std::minstd_rand whose whole state
+///   is one uint32_t. It is what replays record, so its outputs must
+///   never change.
+/// - SPLIT_MIX is counter-based. The n-th output is a SplitMix64 hash
+///   of a 64-bit key and n, so any number of independent streams can
+///   be derived by split() without touching the parent.
+///
+/// Both modes satisfy UniformRandomBitGenerator with the range of
+/// std::minstd_rand, so std::shuffle() and distributions work on either.
+///
 class Rand
 {
 public:
+    enum class Mode { MINSTD, SPLIT_MIX };
+
+    using result_type = uint32_t;
+
+    static Rand splitMix(uint64_t seed);
+
     Rand();
     Rand(const Rand &copy) = default;
     Rand &operator=(const Rand &assign) = default;
     ~Rand() = default;
 
+    static constexpr result_type min()
+    {
+        return std::minstd_rand::min();
+    }
+
+    static constexpr result_type max()
+    {
+        return std::minstd_rand::max();
+    }
+
+    result_type operator()();
+
     int32_t gen();
     int32_t gen(int32_t mod);
     uint32_t state() const;
     void set(uint32_t state);
 
-    std::minstd_rand &getUrbg();
+    Mode mode() const;
+    Rand split(uint64_t streamId) const;
+
+private:
+    uint64_t next64();
 
 private:
+    Mode mMode = Mode::MINSTD;
     std::minstd_rand mGen;
     std::uniform_int_distribution<int> mDist;
+    uint64_t mKey = 0;
+    uint64_t mCounter = 0;
 };
 
 
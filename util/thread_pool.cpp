@@ -0,0 +1,117 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cassert>
+
+
+
+namespace saki
+{
+
+
+
+namespace util
+{
+
+
+
+///
+/// \param threadCt Total number of threads including the caller of run(),
+///                 non-positive to use the hardware concurrency
+///
+ThreadPool::ThreadPool(int threadCt)
+{
+    if (threadCt <= 0)
+        threadCt = std::max(1u, std::thread::hardware_concurrency());
+
+    for (int i = 1; i < threadCt; i++)
+        mWorkers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mQuit = true;
+    }
+
+    mWake.notify_all();
+    for (std::thread &t : mWorkers)
+        t.join();
+}
+
+///
+/// \brief Number of threads running tasks, the caller of run() included
+///
+int ThreadPool::threadCt() const
+{
+    return mWorkers.size() + 1;
+}
+
+///
+/// \brief Call 'task' with every index in [0, taskCt) and wait them all
+///
+/// Tasks may run in any order and concurrently with each other.
+/// Must not be called concurrently or from inside a task.
+///
+void ThreadPool::run(int taskCt, const std::function<void(int)> &task)
+{
+    if (taskCt <= 0)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        assert(mTask == nullptr);
+        mTask = &task;
+        mTaskCt = taskCt;
+        mNext = 0;
+        mBusyCt = mWorkers.size();
+        mRunId++;
+    }
+
+    mWake.notify_all();
+    drain();
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mDone.wait(lock, [this]() { return mBusyCt == 0; });
+    mTask = nullptr;
+}
+
+void ThreadPool::work()
+{
+    uint64_t seen = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWake.wait(lock, [this, seen]() { return mQuit || mRunId != seen; });
+            if (mQuit)
+                return;
+
+            seen = mRunId;
+        }
+
+        drain();
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (--mBusyCt == 0)
+            mDone.notify_one();
+    }
+}
+
+///
+/// \brief Run tasks of the current run until none is left
+///
+void ThreadPool::drain()
+{
+    for (int i = mNext++; i < mTaskCt; i = mNext++)
+        (*mTask)(i);
+}
+
+
+
+} // namespace util
+
+
+
+} // namespace saki
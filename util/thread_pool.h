@@ -0,0 +1,71 @@
+#ifndef SAKI_THREAD_POOL_H
+#define SAKI_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+
+
+namespace saki
+{
+
+
+
+namespace util
+{
+
+
+
+///
+/// \brief Fixed set of worker threads running indexed tasks
+///
+/// Workers are started once and sleep between runs. Within a run,
+/// both the workers and the calling thread pull task indices from a
+/// shared counter, so uneven tasks are balanced automatically.
+///
+class ThreadPool
+{
+public:
+    explicit ThreadPool(int threadCt = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &copy) = delete;
+    ThreadPool &operator=(const ThreadPool &assign) = delete;
+
+    int threadCt() const;
+
+    void run(int taskCt, const std::function<void(int)> &task);
+
+private:
+    void work();
+    void drain();
+
+private:
+    std::vector<std::thread> mWorkers;
+    std::mutex mMutex;
+    std::condition_variable mWake;
+    std::condition_variable mDone;
+    const std::function<void(int)> *mTask = nullptr;
+    int mTaskCt = 0;
+    std::atomic<int> mNext { 0 };
+    int mBusyCt = 0; ///< Number of workers not finished with the current run
+    uint64_t mRunId = 0;
+    bool mQuit = false;
+};
+
+
+
+} // namespace util
+
+
+
+} // namespace saki
+
+
+
+#endif // SAKI_THREAD_POOL_H